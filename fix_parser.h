@@ -38,6 +38,7 @@ extern "C"
 // configuration
 #define MAX_MESSAGE_LEN 100000
 #define MAX_GROUP_DEPTH 10
+#define MAX_COMPILED_TAG 65535	// classifiers without a node table get compiled into tables covering tags up to this value
 
 // FIX version
 typedef enum { FIX_4_2, FIX_4_3, FIX_4_4, FIX_5_0 } fix_message_version;
@@ -61,6 +62,39 @@ struct fix_tag
 	struct fix_group_node* group;
 };
 
+// table-driven node specification
+// Bitsets hold one bit per tag, tag t being bit (t % 8) of byte (t / 8); they cover tags from 0 to max_tag - 1.
+struct fix_node_table;
+
+struct fix_data_tag_entry
+{
+	size_t length_tag, data_tag;
+};
+
+struct fix_group_entry
+{
+	size_t length_tag;
+	const struct fix_node_table* node;
+};
+
+struct fix_node_table
+{
+	size_t first_tag;						// the first tag of a group node, or 0 for a message
+	size_t max_tag;
+	const unsigned char* valid;				// valid tags
+	const unsigned char* special;			// length tags listed in data_tags and groups
+	const unsigned char* interesting;		// interest set (see fix_tag_classifier), or NULL for all tags
+	const struct fix_data_tag_entry* data_tags;	// sorted by the length tag
+	size_t num_data_tags;
+	const struct fix_group_entry* groups;		// sorted by the length tag
+	size_t num_groups;
+	const struct fix_tag_classifier* fallback;	// classifier for the tags from max_tag onwards, or NULL if they are invalid;
+												// group length tags must be below max_tag
+	const unsigned short* ranks;			// optional: number of valid tags below each byte of the valid bitset,
+											// (max_tag + 7) / 8 + 1 entries, the last one being the total; gives every
+											// valid tag its own storage slot in the message node, NULL for hashed storage
+};
+
 // parser control table entry
 struct fix_tag_classifier
 {
@@ -68,6 +102,13 @@ struct fix_tag_classifier
 	size_t (*get_data_tag)(size_t tag);
 	int (*is_first_in_group)(size_t tag);
 	const struct fix_tag_classifier* (*get_group_classifier)(size_t tag);
+	// optional interest set: valid tags not in the set are validated, but not stored in the node,
+	// and groups not in the set are validated without building their nodes; NULL means all tags are stored
+	int (*is_interesting_tag)(size_t tag);
+	// optional node table; if not NULL, the parser uses the table instead of the functions above, otherwise
+	// the functions are compiled into a table on the first use of the classifier, once per process; the table
+	// covers tags up to MAX_COMPILED_TAG, and group length tags above that value are rejected as message errors
+	const struct fix_node_table* table;
 };
 
 // parser control table entry
@@ -86,10 +127,80 @@ void free_fix_parser(struct fix_parser* parser);
 // returns parser error or NULL
 const char* get_fix_parser_error(struct fix_parser* parser);
 
+// splitter recovery mode: instead of making the parser unusable, invalid input bytes get skipped
+// up to the next "8=FIX" where the splitting resumes. The callback, if not NULL, is invoked with the number
+// of bytes skipped every time the splitter finds a new message start.
+void enable_fix_parser_recovery(struct fix_parser* parser, void (*on_skip)(void* context, size_t num_bytes), void* context);
+
+// returns the total number of bytes skipped in recovery mode
+size_t get_fix_parser_skipped_bytes(struct fix_parser* parser);
+
+// message type filter: invoked by the splitter as soon as the message type is known; if it returns 0,
+// the message body is skipped without copying or parsing, and the message is not returned by the iterator.
+// The checksum of a skipped message is only verified if verify_checksum is non-zero.
+typedef int (*fix_message_filter)(void* context, fix_message_version version, const char* msg_type);
+
+void set_fix_message_filter(struct fix_parser* parser, fix_message_filter filter, void* context, int verify_checksum);
+
+// returns the number of messages rejected by the message filter
+size_t get_fix_parser_filtered_count(struct fix_parser* parser);
+
 // message iterator
 const struct fix_message* get_first_fix_message(struct fix_parser* parser, const void* bytes, size_t n);
 const struct fix_message* get_next_fix_message(struct fix_parser* parser);
 
+// same as get_first_fix_message(), but every message that fits completely into the given bytes
+// is parsed directly from there, without copying; only the messages crossing chunk boundaries
+// are copied into the parser's own buffer. The bytes get modified by the parser, and must remain valid
+// while the messages from this chunk are being processed.
+const struct fix_message* get_first_fix_message_in_place(struct fix_parser* parser, void* bytes, size_t n);
+
+// batch interface: parses all complete messages from the given bytes at once, returning an array
+// of *p_count messages; the messages are independent of each other and remain valid until the next
+// call to one of the batch functions on the same parser.
+const struct fix_message* const* get_fix_message_batch(struct fix_parser* parser, const void* bytes, size_t n, size_t* p_count);
+const struct fix_message* const* get_fix_message_batch_in_place(struct fix_parser* parser, void* bytes, size_t n, size_t* p_count);
+
+// raw messages mode: the parser keeps a copy of the exact message bytes, from "8=" to the SOH after the checksum,
+// taken before the parsing modifies them; get_fix_message_raw() returns the bytes and sets *p_length, or returns
+// NULL if the mode is not enabled. The bytes remain valid for as long as the message.
+void enable_fix_parser_raw_messages(struct fix_parser* parser);
+const char* get_fix_message_raw(const struct fix_message* msg, size_t* p_length);
+
+// lazy groups mode: the repeating groups of the message root node are only scanned for their end at parse
+// time, and the nodes of such a group get built from its bytes on the first get_fix_tag(), get_fix_node_tag()
+// or get_fix_group() call that returns the group tag. Errors inside a lazy group are not reported as message
+// errors: the group tag of an invalid group has no nodes (NULL fix_tag.group).
+void enable_fix_parser_lazy_groups(struct fix_parser* parser);
+
+// tag streaming mode
+typedef enum { FIX_TAG, FIX_GROUP_BEGIN, FIX_GROUP_NODE, FIX_GROUP_END } fix_tag_event;
+
+// FIX_TAG: a regular tag in the wire order;
+// FIX_GROUP_BEGIN, FIX_GROUP_END: a repeating group starts or ends, the tag is the group length tag with
+// the number of nodes as its length and NULL value;
+// FIX_GROUP_NODE: the next node of the group starts, the tag is the same as for FIX_GROUP_BEGIN.
+// Returning 0 from the callback stops processing of the remaining tags of the current message.
+typedef int (*fix_tag_callback)(void* context, fix_tag_event event, const struct fix_tag* tag);
+
+// Switches the parser to the tag streaming mode (or back to the normal mode if the callback is NULL).
+// In the streaming mode no message tree gets built: instead, the callback is invoked for every tag
+// of every message, as the message iterator runs. The messages are validated by the classifier
+// as usual, except that duplicate tags are not detected, and their root nodes are always empty.
+void set_fix_tag_callback(struct fix_parser* parser, fix_tag_callback callback, void* context);
+
+// FIX log file replay
+typedef void (*fix_message_handler)(void* context, const struct fix_message* msg);
+
+// Memory-maps the given FIX log file, divides it into num_threads regions starting at message boundaries,
+// and parses the regions in parallel, one parser per thread. For every message in region i the handler is
+// invoked with contexts[i] (or NULL if contexts is NULL) on the thread processing the region. Messages within
+// a region are processed in the file order, and region i + 1 follows region i in the file, so the results
+// collected per region can be combined in the original order. Line breaks, spaces and tabs between
+// the messages are skipped.
+// Returns NULL on success, or an error message valid until the next call from the same thread.
+const char* parse_fix_log_file(const char* file_name, classifier_func cf, size_t num_threads, fix_message_handler handler, void* const* contexts);
+
 // returns message root node
 const struct fix_group_node* get_fix_message_root_node(const struct fix_message* msg);
 
@@ -99,9 +210,29 @@ size_t get_fix_node_size(const struct fix_group_node* node);
 // group node iterator
 const struct fix_group_node* get_next_fix_node(const struct fix_group_node* pnode);
 
+// random access to the nodes of a group: the group is the first node, as in fix_tag.group;
+// the nodes are laid out contiguously, so get_fix_group_entry(group, i) == group + i.
+// Returns the number of nodes in the group, or the i-th node (NULL if i is out of range).
+size_t get_fix_group_size(const struct fix_group_node* group);
+const struct fix_group_node* get_fix_group_entry(const struct fix_group_node* group, size_t i);
+
 // returns pointer to struct fix_tag or NULL if tag not found
 const struct fix_tag* get_fix_tag(const struct fix_group_node* node, size_t tag);
 
+// tag iterator: returns the i-th tag of the node in the wire order, or NULL if i >= get_fix_node_size(node);
+// a group tag is followed by the tags after the group, its nodes being accessible via fix_tag.group.
+// Tags outside the interest set of the node (see fix_tag_classifier) are not stored, and so not iterated.
+const struct fix_tag* get_fix_node_tag(const struct fix_group_node* node, size_t i);
+
+// The nodes look tags up in a compact 16 byte layout (32 bit tag, length and value offset), next to the struct
+// fix_tag records built at parse time; none of the accessors modify the message, so a parsed message may be
+// read from several threads at once, except in the lazy groups mode, where the accessors build the groups.
+// The accessors below read the compact layout directly:
+// get_fix_tag_value() returns the tag value and its length, or NULL if the tag is not found or is a group tag;
+// get_fix_group() returns the first node of the group, or NULL if the tag is not found or is not a group tag.
+const char* get_fix_tag_value(const struct fix_group_node* node, size_t tag, size_t* p_length);
+const struct fix_group_node* get_fix_group(const struct fix_group_node* node, size_t tag);
+
 // returns tag value as string or NULL if tag is not found
 const char* get_fix_tag_as_string(const struct fix_group_node* node, size_t tag);
 
@@ -110,7 +241,19 @@ const char* get_fix_tag_as_string(const struct fix_group_node* node, size_t tag)
 // double = value / pow(10.0, num_frac);
 int get_fix_tag_as_real(const struct fix_group_node* node, size_t tag, int64_t* p_value);
 
-// converts the tag value to double,
+// fixed-point decimal: value = mantissa * pow(10, exponent), where exponent <= 0
+struct fix_decimal
+{
+	int64_t mantissa;
+	int exponent;
+};
+
+// converts the tag value to the decimal, keeping all the digits after the decimal point (the exponent
+// of "23.50" is -2), unless only dropping the trailing zeros makes the mantissa fit into 64 bits;
+// returns non-zero on success or 0 if conversion fails, the value does not fit, or tag not found.
+int get_fix_tag_as_decimal(const struct fix_group_node* node, size_t tag, struct fix_decimal* p_value);
+
+// converts the tag value to the nearest double, independent of the current locale and keeping the sign of zero,
 // returns number of digits after the decimal point or -1 if conversion fails or tag not found.
 int get_fix_tag_as_double(const struct fix_group_node* node, size_t tag, double* p_value);
 
@@ -125,16 +268,54 @@ int get_fix_tag_as_integer(const struct fix_group_node* node, size_t tag, int64_
 int get_fix_tag_as_boolean(const struct fix_group_node* node, size_t tag);
 
 // time conversion functions
+// The functions remember the last date converted on the calling thread, so that the next timestamp
+// with the same date only has its time parsed.
 
 // Treats the tag value as UTCTimestamp FIX type and returns the number of 100-nanosecond intervals 
-// since January 1, 1601 (for Windows platform) or since January 1, 1900 (for Linux),
-// or -1LL if conversion fails or tag not found.
-// Note: The range of dates is more narrow than in the FIX specification.
+// since January 1, 1601 (for Windows platform) or since January 1, 1970 (for Linux), negative for the times
+// before that, or -1LL if conversion fails or tag not found.
 int64_t get_fix_tag_as_utc_timestamp(const struct fix_group_node* node, size_t tag);
 
-// Treats the tag value as LocalMktDate FIX type and returns it as time_t or (time_t)-1 if conversion fails or tag not found.
+// Treats the tag value as UTCTimestamp FIX type with whole seconds, milliseconds, microseconds or nanoseconds
+// and stores the number of nanoseconds since January 1, 1970 in *p_value. Returns the number of digits after
+// the decimal point (0, 3, 6 or 9), or -1 if conversion fails, tag not found, or the time does not fit
+// into 64 bits (years 1677 to 2262 do).
+int get_fix_tag_as_utc_timestamp_ns(const struct fix_group_node* node, size_t tag, int64_t* p_value);
+
+// Treats the tag value as LocalMktDate FIX type and returns the midnight of the date in the local time zone
+// of the process as time_t (see mktime()), or (time_t)-1 if conversion fails, tag not found, or the date
+// does not fit into time_t.
 time_t get_fix_tag_as_local_mkt_date(const struct fix_group_node* node, size_t tag);
 
+// Same as above, for the market with the given offset to UTC in minutes (e.g. -300 for New York in winter)
+// instead of the time zone of the process; utc_offset 0 takes the date as UTC.
+time_t get_fix_tag_as_local_mkt_date_tz(const struct fix_group_node* node, size_t tag, int utc_offset);
+
+// Treats the tag value as UTCDateOnly FIX type and returns the midnight of the date as time_t,
+// or (time_t)-1 if conversion fails, tag not found, or the date does not fit into time_t.
+time_t get_fix_tag_as_utc_date_only(const struct fix_group_node* node, size_t tag);
+
+// Treats the tag value as UTCTimeOnly FIX type and stores the number of nanoseconds since midnight in *p_value.
+// Returns the number of digits after the decimal point (0, 3, 6 or 9), or -1 if conversion fails or tag not found.
+int get_fix_tag_as_utc_time_only(const struct fix_group_node* node, size_t tag, int64_t* p_value);
+
+// Treats the tag value as TZTimestamp FIX type and stores the number of nanoseconds since January 1, 1970 UTC
+// in *p_value. Returns the number of digits after the decimal point (0, 3, 6 or 9), or -1 if conversion fails,
+// tag not found, or the time does not fit into 64 bits. A value without the time zone is taken as UTC.
+int get_fix_tag_as_tz_timestamp(const struct fix_group_node* node, size_t tag, int64_t* p_value);
+
+// MonthYear FIX type: YYYYMM with optional day of the month (YYYYMMDD) or week code (YYYYMMwN)
+struct fix_month_year
+{
+	unsigned short year;
+	unsigned char month;
+	unsigned char day;	// 1-31, or 0 if not given
+	unsigned char week;	// 1-5, or 0 if not given
+};
+
+// Treats the tag value as MonthYear FIX type and returns non-zero on success or 0 if conversion fails or tag not found.
+int get_fix_tag_as_month_year(const struct fix_group_node* node, size_t tag, struct fix_month_year* p_value);
+
 // parser table helper macros
 #define GROUP_NODE(name, first_tag)	\
 	static int is_first_in_group_ ## name(size_t __tag) { return (__tag == (first_tag)) ? 1 : 0; }
@@ -149,11 +330,18 @@ time_t get_fix_tag_as_local_mkt_date(const struct fix_group_node* node, size_t t
 	&PARSER_TABLE(name)
 
 #define END_NODE(name)	\
-	static const struct fix_tag_classifier PARSER_TABLE(name) = { &is_valid_in_ ## name, &get_data_tag_in_ ## name, &is_first_in_group_ ## name, &get_group_classifier_in_ ## name }
+	static const struct fix_tag_classifier PARSER_TABLE(name) = { &is_valid_in_ ## name, &get_data_tag_in_ ## name, &is_first_in_group_ ## name, &get_group_classifier_in_ ## name, NULL, NULL }
 
 #define END_MESSAGE(name)	\
 	END_NODE(name)
 
+// same as END_NODE/END_MESSAGE, but with the interest set defined by INTERESTING_TAGS(name)
+#define END_FILTERED_NODE(name)	\
+	static const struct fix_tag_classifier PARSER_TABLE(name) = { &is_valid_in_ ## name, &get_data_tag_in_ ## name, &is_first_in_group_ ## name, &get_group_classifier_in_ ## name, &is_interesting_in_ ## name, NULL }
+
+#define END_FILTERED_MESSAGE(name)	\
+	END_FILTERED_NODE(name)
+
 #define VALID_TAGS(name)	\
 	static int is_valid_in_ ## name(size_t __tag) { switch(__tag) {
 
@@ -163,6 +351,12 @@ time_t get_fix_tag_as_local_mkt_date(const struct fix_group_node* node, size_t t
 #define END_VALID_TAGS	\
 	return 1;	default: return 0; } }
 
+#define INTERESTING_TAGS(name)	\
+	static int is_interesting_in_ ## name(size_t __tag) { switch(__tag) {
+
+#define END_INTERESTING_TAGS	\
+	return 1;	default: return 0; } }
+
 #define DATA_TAGS(name)	\
 	static size_t get_data_tag_in_ ## name(size_t __tag) { switch(__tag) {
 
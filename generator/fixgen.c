@@ -0,0 +1,1129 @@
+/*
+Copyright (c) 2013, 2014, 2015, Maxim Konakov
+ All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list
+   of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, this list
+   of conditions and the following disclaimer in the documentation and/or other materials
+   provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY
+AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// FIX parser table generator.
+// Reads QuickFIX-style XML data dictionaries and writes C source with the node tables (see struct fix_node_table)
+// for every message type, plus a classifier function dispatching on the message type via a perfect hash.
+// Usage: fixgen [-p prefix] [-i path/to/fix_parser.h] dictionary.xml...
+// FIX 5.0 application dictionaries take their header, trailer and session messages from a FIXT.1.1 dictionary
+// given in the same run. The result goes to stdout; the classifier function is called <prefix>_classifier.
+
+#include "../fix_parser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+typedef enum { NO, YES } boolean;
+
+// helpers ----------------------------------------------------------------------------------------
+static
+void fail(const char* fmt, ...)
+{
+	va_list args;
+
+	fputs("fixgen: ", stderr);
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	fputc('\n', stderr);
+	exit(1);
+}
+
+static
+void* xrealloc(void* p, size_t n)
+{
+	p = realloc(p, n);
+
+	if(!p)
+		fail("out of memory");
+
+	return p;
+}
+
+#define PUSH(arr, n, cap, value)	\
+	do {	\
+		if((n) == (cap)) { (cap) = (cap) ? 2 * (cap) : 8; (arr) = xrealloc((arr), (cap) * sizeof(*(arr))); }	\
+		(arr)[(n)++] = (value);	\
+	} while(0)
+
+// text buffer
+struct text
+{
+	char* str;
+	size_t size, capacity;
+};
+
+static
+void append_text(struct text* t, const char* fmt, ...)
+{
+	int n;
+	va_list args;
+	char buff[200];
+
+	va_start(args, fmt);
+	n = vsnprintf(buff, sizeof(buff), fmt, args);
+	va_end(args);
+
+	if(n < 0 || (size_t)n >= sizeof(buff))
+		fail("formatted text longer than %u bytes", (unsigned)(sizeof(buff) - 1));
+
+	if(t->size + n + 1 > t->capacity)
+	{
+		t->capacity = 2 * (t->size + n + 1);
+		t->str = xrealloc(t->str, t->capacity);
+	}
+
+	memcpy(t->str + t->size, buff, n + 1);
+	t->size += n;
+}
+
+// XML reader -------------------------------------------------------------------------------------
+// a minimal parser for the dictionary files: elements and attributes only, text content is ignored
+struct xml_attr
+{
+	const char* name;
+	const char* value;
+};
+
+struct xml_element
+{
+	const char* name;
+	struct xml_attr* attrs;
+	size_t num_attrs, cap_attrs;
+	struct xml_element** children;
+	size_t num_children, cap_children;
+};
+
+static
+const char* get_attr(const struct xml_element* e, const char* name)
+{
+	size_t i;
+
+	for(i = 0; i < e->num_attrs; ++i)
+		if(strcmp(e->attrs[i].name, name) == 0)
+			return e->attrs[i].value;
+
+	return NULL;
+}
+
+static
+const struct xml_element* get_child(const struct xml_element* e, const char* name)
+{
+	size_t i;
+
+	for(i = 0; i < e->num_children; ++i)
+		if(strcmp(e->children[i]->name, name) == 0)
+			return e->children[i];
+
+	return NULL;
+}
+
+static
+int is_name_char(char c)
+{
+	return c != 0 && c != '>' && c != '/' && c != '=' && c != ' ' && c != '\t' && c != '\r' && c != '\n';
+}
+
+static
+char* skip_space(char* s)
+{
+	while(*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n')
+		++s;
+
+	return s;
+}
+
+// replaces the predefined entities in place
+static
+void decode_entities(char* s)
+{
+	static const char* const names[] = { "&amp;", "&lt;", "&gt;", "&quot;", "&apos;" };
+	static const char chars[] = "&<>\"'";
+	char* d = s;
+
+	while(*s)
+	{
+		size_t i;
+
+		if(*s == '&')
+		{
+			for(i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+			{
+				const size_t n = strlen(names[i]);
+
+				if(strncmp(s, names[i], n) == 0)
+				{
+					*d++ = chars[i];
+					s += n;
+					break;
+				}
+			}
+
+			if(i < sizeof(names) / sizeof(names[0]))
+				continue;
+		}
+
+		*d++ = *s++;
+	}
+
+	*d = 0;
+}
+
+static
+struct xml_element* new_element(const char* name)
+{
+	struct xml_element* const e = xrealloc(NULL, sizeof(struct xml_element));
+
+	memset(e, 0, sizeof(struct xml_element));
+	e->name = name;
+	return e;
+}
+
+static
+char* skip_past(char* s, const char* str, const char* file_name)
+{
+	char* const p = strstr(s, str);
+
+	if(!p)
+		fail("%s: unterminated markup", file_name);
+
+	return p + strlen(str);
+}
+
+// parses the text in place, returning the document root element
+static
+struct xml_element* parse_xml(char* s, const char* file_name)
+{
+	struct xml_element* stack[100];
+	size_t depth = 0;
+
+	stack[0] = new_element("#document");
+
+	for(s = strchr(s, '<'); s; s = strchr(s, '<'))
+	{
+		if(strncmp(s, "<?", 2) == 0)
+			s = skip_past(s, "?>", file_name);
+		else if(strncmp(s, "<!--", 4) == 0)
+			s = skip_past(s, "-->", file_name);
+		else if(strncmp(s, "<!", 2) == 0)
+			s = skip_past(s, ">", file_name);
+		else if(s[1] == '/')
+		{	// closing tag
+			char* const name = s + 2;
+
+			for(s = name; is_name_char(*s); ++s);
+
+			if(depth == 0 || strncmp(stack[depth]->name, name, (size_t)(s - name)) != 0 || stack[depth]->name[s - name] != 0)
+				fail("%s: mismatched closing tag", file_name);
+
+			--depth;
+			s = skip_past(s, ">", file_name);
+		}
+		else
+		{	// opening tag
+			struct xml_element* e;
+			char* const name = s + 1;
+
+			for(s = name; is_name_char(*s); ++s);
+
+			if(s == name)
+				fail("%s: invalid element name", file_name);
+
+			e = new_element(name);
+			PUSH(stack[depth]->children, stack[depth]->num_children, stack[depth]->cap_children, e);
+
+			for(;;)
+			{
+				struct xml_attr attr;
+				char* p = skip_space(s);
+				const char c = *p;
+				char quote;
+
+				*s = 0;	// terminates the element name or is past the previous attribute value
+
+				if(c == '>')
+				{
+					if(depth + 1 == sizeof(stack) / sizeof(stack[0]))
+						fail("%s: elements nested too deep", file_name);
+
+					stack[++depth] = e;
+					s = p + 1;
+					break;
+				}
+
+				if(c == '/' && p[1] == '>')
+				{
+					s = p + 2;
+					break;
+				}
+
+				if(p == s)
+					fail("%s: invalid element '%s'", file_name, e->name);
+
+				// attribute
+				attr.name = p;
+
+				for(s = p; is_name_char(*s); ++s);
+
+				p = skip_space(s);
+
+				if(s == attr.name || *p != '=')
+					fail("%s: invalid attribute in element '%s'", file_name, e->name);
+
+				*s = 0;
+				p = skip_space(p + 1);
+				quote = *p;
+
+				if(quote != '"' && quote != '\'')
+					fail("%s: invalid attribute value in element '%s'", file_name, e->name);
+
+				attr.value = ++p;
+				s = strchr(p, quote);
+
+				if(!s)
+					fail("%s: unterminated attribute value in element '%s'", file_name, e->name);
+
+				*s++ = 0;
+				decode_entities(p);
+				PUSH(e->attrs, e->num_attrs, e->cap_attrs, attr);
+			}
+		}
+	}
+
+	if(depth != 0)
+		fail("%s: unterminated element '%s'", file_name, stack[depth]->name);
+
+	return stack[0];
+}
+
+static
+struct xml_element* read_xml_file(const char* file_name)
+{
+	long n;
+	char* text;
+	FILE* const file = fopen(file_name, "rb");
+
+	if(!file)
+		fail("cannot open file %s", file_name);
+
+	if(fseek(file, 0, SEEK_END) != 0 || (n = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0)
+		fail("cannot read file %s", file_name);
+
+	text = xrealloc(NULL, (size_t)n + 1);
+
+	if(fread(text, 1, (size_t)n, file) != (size_t)n)
+		fail("cannot read file %s", file_name);
+
+	text[n] = 0;
+	fclose(file);
+
+	return parse_xml(text, file_name);
+}
+
+// dictionary -------------------------------------------------------------------------------------
+struct field
+{
+	const char* name;
+	const char* type;
+	size_t tag;
+};
+
+struct dictionary
+{
+	const char* file_name;
+	int version;	// fix_message_version, or -1 for the transport dictionary
+	const struct xml_element *header, *trailer, *messages;
+	struct field* fields;			// sorted by name
+	size_t num_fields;
+	const struct xml_element** components;	// sorted by name
+	size_t num_components;
+	const struct dictionary* transport;	// FIXT dictionary for FIX 5.0, or NULL
+};
+
+static
+int compare_fields(const void* a, const void* b)
+{
+	return strcmp(((const struct field*)a)->name, ((const struct field*)b)->name);
+}
+
+static
+int compare_components(const void* a, const void* b)
+{
+	return strcmp(get_attr(*(const struct xml_element* const*)a, "name"), get_attr(*(const struct xml_element* const*)b, "name"));
+}
+
+static
+const char* get_required_attr(const struct dictionary* dict, const struct xml_element* e, const char* name)
+{
+	const char* const value = get_attr(e, name);
+
+	if(!value)
+		fail("%s: element '%s' has no attribute '%s'", dict->file_name, e->name, name);
+
+	return value;
+}
+
+static
+void load_dictionary(struct dictionary* dict, const char* file_name)
+{
+	size_t i, cap = 0;
+	const char *type, *major, *minor;
+	const struct xml_element *root, *fields, *components;
+
+	memset(dict, 0, sizeof(struct dictionary));
+	dict->file_name = file_name;
+	root = get_child(read_xml_file(file_name), "fix");
+
+	if(!root)
+		fail("%s: not a FIX dictionary", file_name);
+
+	// version
+	type = get_attr(root, "type");
+	major = get_required_attr(dict, root, "major");
+	minor = get_required_attr(dict, root, "minor");
+
+	if(type && strcmp(type, "FIXT") == 0)
+		dict->version = -1;
+	else if(strcmp(major, "4") == 0 && strcmp(minor, "2") == 0)
+		dict->version = FIX_4_2;
+	else if(strcmp(major, "4") == 0 && strcmp(minor, "3") == 0)
+		dict->version = FIX_4_3;
+	else if(strcmp(major, "4") == 0 && strcmp(minor, "4") == 0)
+		dict->version = FIX_4_4;
+	else if(strcmp(major, "5") == 0)
+		dict->version = FIX_5_0;
+	else
+		fail("%s: unsupported FIX version %s.%s", file_name, major, minor);
+
+	dict->header = get_child(root, "header");
+	dict->trailer = get_child(root, "trailer");
+	dict->messages = get_child(root, "messages");
+
+	// fields
+	fields = get_child(root, "fields");
+
+	if(fields)
+	{
+		for(i = 0; i < fields->num_children; ++i)
+		{
+			struct field f;
+			const struct xml_element* const e = fields->children[i];
+			const char* const number = get_required_attr(dict, e, "number");
+			char* end;
+
+			f.name = get_required_attr(dict, e, "name");
+			f.type = get_required_attr(dict, e, "type");
+			f.tag = (size_t)strtoul(number, &end, 10);
+
+			if(*end != 0 || f.tag == 0)
+				fail("%s: invalid number of field '%s'", file_name, f.name);
+
+			PUSH(dict->fields, dict->num_fields, cap, f);
+		}
+
+		qsort(dict->fields, dict->num_fields, sizeof(struct field), compare_fields);
+	}
+
+	// components
+	components = get_child(root, "components");
+	cap = 0;
+
+	if(components)
+	{
+		for(i = 0; i < components->num_children; ++i)
+		{
+			get_required_attr(dict, components->children[i], "name");
+			PUSH(dict->components, dict->num_components, cap, components->children[i]);
+		}
+
+		qsort(dict->components, dict->num_components, sizeof(struct xml_element*), compare_components);
+	}
+}
+
+static
+const struct field* find_field(const struct dictionary* dict, const char* name)
+{
+	for(; dict; dict = dict->transport)
+	{
+		struct field key;
+		const struct field* p;
+
+		key.name = name;
+		p = (const struct field*)bsearch(&key, dict->fields, dict->num_fields, sizeof(struct field), compare_fields);
+
+		if(p)
+			return p;
+	}
+
+	return NULL;
+}
+
+static
+const struct field* get_field(const struct dictionary* dict, const char* name)
+{
+	const struct field* const p = find_field(dict, name);
+
+	if(!p)
+		fail("%s: unknown field '%s'", dict->file_name, name);
+
+	return p;
+}
+
+static
+const struct xml_element* get_component(const struct dictionary* dict, const char* name)
+{
+	const struct dictionary* d;
+
+	for(d = dict; d; d = d->transport)
+	{
+		struct xml_element key_element;
+		struct xml_attr key_attr;
+		const struct xml_element* const key = &key_element;
+		const struct xml_element* const* p;
+
+		memset(&key_element, 0, sizeof(key_element));
+		key_attr.name = "name";
+		key_attr.value = name;
+		key_element.attrs = &key_attr;
+		key_element.num_attrs = 1;
+
+		p = (const struct xml_element* const*)bsearch(&key, d->components, d->num_components, sizeof(struct xml_element*), compare_components);
+
+		if(p)
+			return *p;
+	}
+
+	fail("%s: unknown component '%s'", dict->file_name, name);
+	return NULL;
+}
+
+// finds the length field for a data field: "<name>Length" or "<name>Len", or the preceding tag of type LENGTH
+static
+const struct field* get_length_field(const struct dictionary* dict, const struct field* data)
+{
+	static const char* const suffixes[] = { "Length", "Len" };
+	char name[200];
+	size_t i;
+	const struct dictionary* d;
+
+	for(i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); ++i)
+	{
+		const struct field* p;
+
+		if(strlen(data->name) + strlen(suffixes[i]) >= sizeof(name))
+			break;
+
+		strcpy(name, data->name);
+		strcat(name, suffixes[i]);
+		p = find_field(dict, name);
+
+		if(p && strcmp(p->type, "LENGTH") == 0)
+			return p;
+	}
+
+	for(d = dict; d; d = d->transport)
+	{
+		for(i = 0; i < d->num_fields; ++i)
+			if(d->fields[i].tag + 1 == data->tag && strcmp(d->fields[i].type, "LENGTH") == 0)
+				return &d->fields[i];
+	}
+
+	fail("%s: no length field for data field '%s'", dict->file_name, data->name);
+	return NULL;
+}
+
+// node specs -------------------------------------------------------------------------------------
+struct node;
+
+struct group_ref
+{
+	size_t length_tag;
+	struct node* node;
+	int id;
+};
+
+struct node
+{
+	size_t first_tag, max_tag;
+	size_t* tags;
+	size_t num_tags, cap_tags;
+	struct fix_data_tag_entry* data_tags;
+	size_t num_data_tags, cap_data_tags;
+	struct group_ref* groups;
+	size_t num_groups, cap_groups;
+};
+
+static
+struct node* new_node()
+{
+	struct node* const node = xrealloc(NULL, sizeof(struct node));
+
+	memset(node, 0, sizeof(struct node));
+	return node;
+}
+
+static
+void add_tag(struct node* node, size_t tag)
+{
+	if(node->num_tags == 0)
+		node->first_tag = tag;
+
+	if(tag >= node->max_tag)
+		node->max_tag = tag + 1;
+
+	PUSH(node->tags, node->num_tags, node->cap_tags, tag);
+}
+
+// adds all fields, components and groups from the given element to the node
+static
+void add_elements(const struct dictionary* dict, const struct xml_element* e, struct node* node, int depth)
+{
+	size_t i;
+
+	if(depth > 50)
+		fail("%s: components nested too deep", dict->file_name);
+
+	for(i = 0; i < e->num_children; ++i)
+	{
+		const struct xml_element* const c = e->children[i];
+		const char* const name = get_required_attr(dict, c, "name");
+
+		if(strcmp(c->name, "field") == 0)
+		{
+			const struct field* const f = get_field(dict, name);
+
+			if(f->tag == 8 || f->tag == 9 || f->tag == 35 || f->tag == 10)
+				continue;	// processed by the splitter
+
+			if(strcmp(f->type, "DATA") == 0)
+			{
+				struct fix_data_tag_entry entry;
+
+				entry.length_tag = get_length_field(dict, f)->tag;
+				entry.data_tag = f->tag;
+				PUSH(node->data_tags, node->num_data_tags, node->cap_data_tags, entry);
+
+				if(entry.length_tag >= node->max_tag)
+					node->max_tag = entry.length_tag + 1;
+
+				// on the wire the length tag comes first, but the parser sees the data tag instead
+				if(node->num_tags == 1 && node->first_tag == entry.length_tag)
+					node->first_tag = f->tag;
+			}
+
+			add_tag(node, f->tag);
+		}
+		else if(strcmp(c->name, "component") == 0)
+			add_elements(dict, get_component(dict, name), node, depth + 1);
+		else if(strcmp(c->name, "group") == 0)
+		{
+			struct group_ref ref;
+			const struct field* const f = get_field(dict, name);
+
+			add_tag(node, f->tag);
+			ref.length_tag = f->tag;
+			ref.node = new_node();
+			ref.id = -1;
+			add_elements(dict, c, ref.node, depth + 1);
+
+			if(ref.node->num_tags == 0)
+				fail("%s: empty group '%s'", dict->file_name, name);
+
+			PUSH(node->groups, node->num_groups, node->cap_groups, ref);
+		}
+	}
+}
+
+// table output -----------------------------------------------------------------------------------
+struct output
+{
+	FILE* file;
+	char** signatures;	// contents of the tables written so far, indexed by the table id
+	size_t num_signatures, cap_signatures;
+};
+
+static
+int compare_tags(const void* a, const void* b)
+{
+	const size_t x = *(const size_t*)a, y = *(const size_t*)b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static
+int compare_data_tags(const void* a, const void* b)
+{
+	return compare_tags(&((const struct fix_data_tag_entry*)a)->length_tag, &((const struct fix_data_tag_entry*)b)->length_tag);
+}
+
+static
+int compare_groups(const void* a, const void* b)
+{
+	return compare_tags(&((const struct group_ref*)a)->length_tag, &((const struct group_ref*)b)->length_tag);
+}
+
+static
+void write_bitset(struct output* out, const char* name, int id, const unsigned char* bits, size_t n)
+{
+	size_t i;
+
+	fprintf(out->file, "static const unsigned char %s_%d[%u] =\n{", name, id, (unsigned)n);
+
+	for(i = 0; i < n; ++i)
+		fprintf(out->file, "%s0x%02X", (i == 0) ? "\n\t" : ((i % 16 == 0) ? ",\n\t" : ", "), bits[i]);
+
+	fputs("\n};\n\n", out->file);
+}
+
+// number of valid tags below each byte of the bitset (see fix_node_table.ranks)
+static
+void write_ranks(struct output* out, int id, const unsigned char* valid, size_t n)
+{
+	size_t i, count = 0;
+
+	fprintf(out->file, "static const unsigned short ranks_%d[%u] =\n{", id, (unsigned)(n + 1));
+
+	for(i = 0; i <= n; ++i)
+	{
+		fprintf(out->file, "%s%u", (i == 0) ? "\n\t" : ((i % 16 == 0) ? ",\n\t" : ", "), (unsigned)count);
+
+		if(i < n)
+		{
+			unsigned b;
+
+			for(b = valid[i]; b != 0; b &= b - 1)
+				++count;
+		}
+	}
+
+	if(count > 65535)
+		fail("too many tags in a message node");
+
+	fputs("\n};\n\n", out->file);
+}
+
+// writes the node table and all its group tables, returning the table id; identical tables are written once
+static
+int write_node(struct output* out, struct node* node)
+{
+	size_t i, n;
+	int id;
+	unsigned char *valid, *special;
+	struct text sig;
+
+	for(i = 0; i < node->num_groups; ++i)
+		node->groups[i].id = write_node(out, node->groups[i].node);
+
+	qsort(node->tags, node->num_tags, sizeof(size_t), compare_tags);
+	qsort(node->data_tags, node->num_data_tags, sizeof(struct fix_data_tag_entry), compare_data_tags);
+	qsort(node->groups, node->num_groups, sizeof(struct group_ref), compare_groups);
+
+	for(i = n = 0; i < node->num_data_tags; ++i)
+	{
+		if(n > 0 && node->data_tags[i].length_tag == node->data_tags[n - 1].length_tag)
+		{
+			if(node->data_tags[i].data_tag != node->data_tags[n - 1].data_tag)
+				fail("conflicting data tags %u and %u", (unsigned)node->data_tags[n - 1].data_tag, (unsigned)node->data_tags[i].data_tag);
+		}
+		else
+			node->data_tags[n++] = node->data_tags[i];
+	}
+
+	node->num_data_tags = n;
+
+	for(i = 1; i < node->num_groups; ++i)
+		if(node->groups[i].length_tag == node->groups[i - 1].length_tag)
+			fail("group %u appears twice in the same node", (unsigned)node->groups[i].length_tag);
+
+	// bitsets
+	n = (node->max_tag + 7) / 8;
+	valid = xrealloc(NULL, n);
+	special = xrealloc(NULL, n);
+	memset(valid, 0, n);
+	memset(special, 0, n);
+
+	for(i = 0; i < node->num_tags; ++i)
+		valid[node->tags[i] / 8] |= (unsigned char)(1u << (node->tags[i] % 8));
+
+	for(i = 0; i < node->num_data_tags; ++i)
+		special[node->data_tags[i].length_tag / 8] |= (unsigned char)(1u << (node->data_tags[i].length_tag % 8));
+
+	for(i = 0; i < node->num_groups; ++i)
+		special[node->groups[i].length_tag / 8] |= (unsigned char)(1u << (node->groups[i].length_tag % 8));
+
+	// skip the table if an identical one has been written already
+	memset(&sig, 0, sizeof(sig));
+	append_text(&sig, "%u %u:", (unsigned)node->first_tag, (unsigned)node->max_tag);
+
+	for(i = 0; i < n; ++i)
+		append_text(&sig, "%02X%02X", valid[i], special[i]);
+
+	for(i = 0; i < node->num_data_tags; ++i)
+		append_text(&sig, " d%u/%u", (unsigned)node->data_tags[i].length_tag, (unsigned)node->data_tags[i].data_tag);
+
+	for(i = 0; i < node->num_groups; ++i)
+		append_text(&sig, " g%u/%d", (unsigned)node->groups[i].length_tag, node->groups[i].id);
+
+	for(id = 0; id < (int)out->num_signatures; ++id)
+	{
+		if(strcmp(out->signatures[id], sig.str) == 0)
+		{
+			free(sig.str);
+			free(valid);
+			free(special);
+			return id;
+		}
+	}
+
+	PUSH(out->signatures, out->num_signatures, out->cap_signatures, sig.str);
+
+	// table
+	write_bitset(out, "valid", id, valid, n);
+	write_bitset(out, "special", id, special, n);
+	write_ranks(out, id, valid, n);
+
+	if(node->num_data_tags > 0)
+	{
+		fprintf(out->file, "static const struct fix_data_tag_entry data_tags_%d[] =\n{\n", id);
+
+		for(i = 0; i < node->num_data_tags; ++i)
+			fprintf(out->file, "\t{ %u, %u }%s\n", (unsigned)node->data_tags[i].length_tag, (unsigned)node->data_tags[i].data_tag, (i + 1 < node->num_data_tags) ? "," : "");
+
+		fputs("};\n\n", out->file);
+	}
+
+	if(node->num_groups > 0)
+	{
+		fprintf(out->file, "static const struct fix_group_entry groups_%d[] =\n{\n", id);
+
+		for(i = 0; i < node->num_groups; ++i)
+			fprintf(out->file, "\t{ %u, &node_%d }%s\n", (unsigned)node->groups[i].length_tag, node->groups[i].id, (i + 1 < node->num_groups) ? "," : "");
+
+		fputs("};\n\n", out->file);
+	}
+
+	fprintf(out->file, "static const struct fix_node_table node_%d =\n{\n\t%u, %u, valid_%d, special_%d, NULL,\n",
+			id, (unsigned)node->first_tag, (unsigned)node->max_tag, id, id);
+
+	if(node->num_data_tags > 0)
+		fprintf(out->file, "\tdata_tags_%d, %u,\n", id, (unsigned)node->num_data_tags);
+	else
+		fputs("\tNULL, 0,\n", out->file);
+
+	if(node->num_groups > 0)
+		fprintf(out->file, "\tgroups_%d, %u,\n", id, (unsigned)node->num_groups);
+	else
+		fputs("\tNULL, 0,\n", out->file);
+
+	fprintf(out->file, "\tNULL,\n\tranks_%d\n};\n\n", id);
+
+	free(valid);
+	free(special);
+	return id;
+}
+
+// messages ---------------------------------------------------------------------------------------
+static const char* const version_names[] = { "FIX_4_2", "FIX_4_3", "FIX_4_4", "FIX_5_0" };
+
+struct message
+{
+	int version;
+	const char* type;
+	const char* name;
+	uint32_t key;
+	int table_id;
+};
+
+// message type packed the same way as in the generated classifier
+static
+uint32_t make_key(const char* type)
+{
+	const size_t n = strlen(type);
+
+	if(n == 0 || n > 3)
+		fail("invalid message type '%s'", type);
+
+	return (uint32_t)(unsigned char)type[0]
+		 | (n > 1 ? (uint32_t)(unsigned char)type[1] << 8 : 0u)
+		 | (n > 2 ? (uint32_t)(unsigned char)type[2] << 16 : 0u);
+}
+
+static
+void add_messages(struct output* out, const struct dictionary* dict, int version, struct message** messages, size_t* num_messages, size_t* cap_messages)
+{
+	size_t i, j;
+	const struct dictionary* const hdict = (dict->header && dict->header->num_children > 0) || !dict->transport ? dict : dict->transport;
+
+	if(!dict->messages)
+		return;
+
+	for(i = 0; i < dict->messages->num_children; ++i)
+	{
+		struct message msg;
+		struct node* const root = new_node();
+		const struct xml_element* const e = dict->messages->children[i];
+
+		msg.version = version;
+		msg.type = get_required_attr(dict, e, "msgtype");
+		msg.name = get_required_attr(dict, e, "name");
+		msg.key = make_key(msg.type);
+
+		for(j = 0; j < *num_messages; ++j)
+			if((*messages)[j].version == version && (*messages)[j].key == msg.key)
+				fail("%s: duplicate message type '%s'", dict->file_name, msg.type);
+
+		if(hdict->header)
+			add_elements(hdict, hdict->header, root, 0);
+
+		add_elements(dict, e, root, 0);
+
+		if(hdict->trailer)
+			add_elements(hdict, hdict->trailer, root, 0);
+
+		root->first_tag = 0;
+		msg.table_id = write_node(out, root);
+		PUSH(*messages, *num_messages, *cap_messages, msg);
+	}
+}
+
+// finds a multiplier that maps the keys to distinct slots of a table with 2^bits entries
+static
+uint32_t find_perfect_hash(const struct message* messages, size_t num_messages, int version, unsigned* p_bits)
+{
+	unsigned bits;
+	uint32_t seed = 0x9E3779B9u;
+	size_t n = 0, i;
+	unsigned char* used;
+
+	for(i = 0; i < num_messages; ++i)
+		n += (messages[i].version == version);
+
+	for(bits = 1; (1u << bits) < n; ++bits);
+
+	used = xrealloc(NULL, (size_t)1 << 16);
+
+	for(; bits <= 16; ++bits)
+	{
+		int attempt;
+
+		for(attempt = 0; attempt < 100000; ++attempt)
+		{
+			const uint32_t mul = seed | 1u;
+
+			seed = seed * 1664525u + 1013904223u;
+			memset(used, 0, (size_t)1 << bits);
+
+			for(i = 0; i < num_messages; ++i)
+			{
+				if(messages[i].version == version)
+				{
+					const uint32_t h = (uint32_t)(messages[i].key * mul) >> (32 - bits);
+
+					if(used[h])
+						break;
+
+					used[h] = 1;
+				}
+			}
+
+			if(i == num_messages)
+			{
+				free(used);
+				*p_bits = bits;
+				return mul;
+			}
+		}
+	}
+
+	fail("cannot find a perfect hash function for %s", version_names[version]);
+	return 0;
+}
+
+static
+void write_classifier(struct output* out, const char* prefix, const struct message* messages, size_t num_messages)
+{
+	int version;
+	size_t i;
+	uint32_t muls[4];
+	unsigned bits[4];
+	boolean present[4] = { NO, NO, NO, NO };
+	unsigned char* written = xrealloc(NULL, out->num_signatures + 1);
+
+	// classifiers for the message tables
+	memset(written, 0, out->num_signatures + 1);
+
+	for(i = 0; i < num_messages; ++i)
+	{
+		present[messages[i].version] = YES;
+
+		if(!written[messages[i].table_id])
+		{
+			written[messages[i].table_id] = 1;
+			fprintf(out->file, "static const struct fix_tag_classifier classifier_%d = { NULL, NULL, NULL, NULL, NULL, &node_%d };\n",
+					messages[i].table_id, messages[i].table_id);
+		}
+	}
+
+	free(written);
+
+	// hash tables
+	fputs("\n// message type dispatch\n"
+		  "struct msg_type_slot\n{\n\tuint32_t key;\n\tconst struct fix_tag_classifier* classifier;\n};\n\n", out->file);
+
+	for(version = 0; version < 4; ++version)
+	{
+		struct message** slots;
+
+		if(!present[version])
+			continue;
+
+		muls[version] = find_perfect_hash(messages, num_messages, version, &bits[version]);
+		slots = xrealloc(NULL, sizeof(struct message*) << bits[version]);
+		memset(slots, 0, sizeof(struct message*) << bits[version]);
+
+		for(i = 0; i < num_messages; ++i)
+			if(messages[i].version == version)
+				slots[(uint32_t)(messages[i].key * muls[version]) >> (32 - bits[version])] = (struct message*)&messages[i];
+
+		fprintf(out->file, "static const struct msg_type_slot slots_%s[%u] =\n{\n", version_names[version], 1u << bits[version]);
+
+		for(i = 0; i < ((size_t)1 << bits[version]); ++i)
+		{
+			const char* const sep = (i + 1 < ((size_t)1 << bits[version])) ? "," : "";
+
+			if(slots[i])
+				fprintf(out->file, "\t{ 0x%06Xu, &classifier_%d }%s\t// %s (%s)\n", (unsigned)slots[i]->key, slots[i]->table_id, sep, slots[i]->name, slots[i]->type);
+			else
+				fprintf(out->file, "\t{ 0, NULL }%s\n", sep);
+		}
+
+		fputs("};\n\n", out->file);
+		free(slots);
+	}
+
+	// classifier function
+	fprintf(out->file,
+		"#ifdef __cplusplus\n"
+		"extern \"C\"\n"
+		"#endif\n"
+		"const struct fix_tag_classifier* %s_classifier(fix_message_version version, const char* msg_type)\n"
+		"{\n"
+		"\tconst struct msg_type_slot* p;\n"
+		"\tconst unsigned char* const s = (const unsigned char*)msg_type;\n"
+		"\tconst uint32_t key = (uint32_t)s[0] | (s[1] ? ((uint32_t)s[1] << 8 | (uint32_t)s[2] << 16) : 0u);\n\n"
+		"\tswitch(version)\n"
+		"\t{\n", prefix);
+
+	for(version = 0; version < 4; ++version)
+	{
+		if(present[version])
+			fprintf(out->file, "\tcase %s:\n\t\tp = &slots_%s[(uint32_t)(key * 0x%08Xu) >> %u];\n\t\tbreak;\n",
+					version_names[version], version_names[version], (unsigned)muls[version], 32 - bits[version]);
+	}
+
+	fputs("\tdefault:\n"
+		  "\t\treturn NULL;\n"
+		  "\t}\n\n"
+		  "\treturn (p->key == key) ? p->classifier : NULL;\n"
+		  "}\n", out->file);
+}
+
+// entry point ------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	int i, k, num_dicts = 0;
+	const char *prefix = "fix", *include = "fix_parser.h";
+	struct dictionary* const dicts = xrealloc(NULL, sizeof(struct dictionary) * (argc > 1 ? argc : 1));
+	struct dictionary* transport = NULL;
+	struct message* messages = NULL;
+	size_t num_messages = 0, cap_messages = 0;
+	struct output out;
+
+	for(i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+			prefix = argv[++i];
+		else if(strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+			include = argv[++i];
+		else if(argv[i][0] == '-')
+			fail("unknown option %s", argv[i]);
+		else
+			load_dictionary(&dicts[num_dicts++], argv[i]);
+	}
+
+	if(num_dicts == 0)
+	{
+		fputs("Usage: fixgen [-p prefix] [-i path/to/fix_parser.h] dictionary.xml...\n", stderr);
+		return 1;
+	}
+
+	for(k = 0; k < num_dicts; ++k)
+	{
+		if(dicts[k].version >= 0)
+		{
+			for(i = 0; i < k; ++i)
+				if(dicts[i].version == dicts[k].version)
+					fail("%s: more than one dictionary for %s", dicts[k].file_name, version_names[dicts[k].version]);
+		}
+		else if(transport)
+			fail("%s: more than one transport dictionary", dicts[k].file_name);
+		else
+			transport = &dicts[k];
+	}
+
+	for(k = 0; k < num_dicts; ++k)
+		if(dicts[k].version == FIX_5_0)
+			dicts[k].transport = transport;
+
+	// output
+	memset(&out, 0, sizeof(out));
+	out.file = stdout;
+
+	fputs("// Generated by fixgen from", out.file);
+
+	for(k = 0; k < num_dicts; ++k)
+	{
+		const char* name = strrchr(dicts[k].file_name, '/');
+
+		fprintf(out.file, " %s", name ? name + 1 : dicts[k].file_name);
+	}
+
+	fprintf(out.file, ", do not edit.\n\n#include \"%s\"\n\n", include);
+
+	for(k = 0; k < num_dicts; ++k)
+	{
+		add_messages(&out, &dicts[k], dicts[k].version >= 0 ? dicts[k].version : FIX_5_0, &messages, &num_messages, &cap_messages);
+	}
+
+	if(num_messages == 0)
+		fail("no messages found");
+
+	write_classifier(&out, prefix, messages, num_messages);
+
+	if(fflush(out.file) != 0 || ferror(out.file))
+		fail("error writing output");
+
+	return 0;
+}
@@ -26,7 +26,22 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 #include <malloc.h>
 #include <memory.h>
 #include <time.h>
+#include <stddef.h>
 #include <assert.h>
+#include <stdlib.h>
+#include <locale.h>
+
+#ifdef _WIN32
+#define STRICT
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 // string buffer ----------------------------------------------------------------------------------
 void string_buffer_ensure_capacity(struct string_buffer* s, size_t n)
@@ -59,17 +74,113 @@ char append_bytes_to_string_buffer_with_checksum(struct string_buffer* sb, const
 	return sum;
 }
 
+char get_checksum(const char* s, size_t n)
+{
+	char sum = 0;
+	const char* const end = s + n;
+
+	while(s != end)
+		sum += *s++;
+
+	return sum;
+}
+
+void append_bytes_to_string_buffer(struct string_buffer* s, const char* bytes, size_t n)
+{
+	if(s->size + n > s->capacity)
+		string_buffer_ensure_capacity(s, 2 * (s->size + n));
+
+	memcpy(s->str + s->size, bytes, n);
+	s->size += n;
+}
+
 void set_buffer_empty(struct string_buffer* s)
 {
 	s->size = 0;
 }
 
+// memory arena ----------------------------------------------------------------------------------
+struct arena_block
+{
+	struct arena_block* next;
+	size_t size;
+	uint64_t data[1];	// size bytes
+};
+
+void* arena_alloc(struct arena* a, size_t n)
+{
+	void* p;
+
+	if(n > (size_t)-1 - 7 - offsetof(struct arena_block, data))
+		return NULL;	// the block size would overflow
+
+	n = (n + 7) & ~(size_t)7;	// keep 8 byte alignment
+
+	if(!a->current || a->used + n > a->current->size)
+	{
+		struct arena_block** const pnext = a->current ? &a->current->next : &a->first;
+
+		if(*pnext && (*pnext)->size >= n)
+			a->current = *pnext;
+		else
+		{
+			// a new block, large enough for the request; a smaller block in the way is kept for later use
+			const size_t size = (n > ARENA_BLOCK_SIZE) ? n : ARENA_BLOCK_SIZE;
+			struct arena_block* const block = (struct arena_block*)malloc(offsetof(struct arena_block, data) + size);
+
+			if(!block)
+				return NULL;
+
+			block->next = *pnext;
+			block->size = size;
+			*pnext = block;
+			a->current = block;
+		}
+
+		a->used = 0;
+	}
+
+	p = (char*)a->current->data + a->used;
+	a->used += n;
+
+	return memset(p, 0, n);
+}
+
+void reset_arena(struct arena* a)
+{
+	a->current = NULL;
+	a->used = 0;
+}
+
+void free_arena(struct arena* a)
+{
+	struct arena_block* p = a->first;
+
+	while(p)
+	{
+		struct arena_block* const next = p->next;
+
+		FREE(p);
+		p = next;
+	}
+
+	a->first = a->current = NULL;
+	a->used = 0;
+}
+
 // real FIX message -------------------------------------------------------------------------------
 void set_message_empty(struct real_fix_message* msg)
 {
 	msg->properties.error = NULL;
 	msg->properties.type[0] = 0;
 	set_group_node_empty(&msg->root);
+
+	if(msg->arena)
+		reset_arena(msg->arena);
+	else
+		msg->arena = ALLOC_Z(struct arena);
+
+	set_buffer_empty(&msg->raw);
 	msg->complete = NO;
 }
 
@@ -79,6 +190,19 @@ const struct fix_group_node* get_fix_message_root_node(const struct fix_message*
 	return msg ? &((const struct real_fix_message*)msg)->root : NULL;	// sorry...
 }
 
+const char* get_fix_message_raw(const struct fix_message* msg, size_t* p_length)
+{
+	const struct string_buffer* const raw = &((const struct real_fix_message*)msg)->raw;
+
+	if(raw->size == 0)
+		return NULL;
+
+	if(p_length)
+		*p_length = raw->size;
+
+	return raw->str;
+}
+
 // helpers ----------------------------------------------------------------------------------------
 // utility for reading tags and lengths
 // returns pointer to the first non-digit or NULL on error
@@ -119,63 +243,129 @@ const char* read_fix_uint(const char* s, const char* const end, size_t* result_p
 // conversion routines ----------------------------------------------------------------------------
 const char* get_fix_tag_as_string(const struct fix_group_node* node, size_t tag)
 {
-	const struct fix_tag* pt;
+	return node ? get_fix_tag_value(node, tag, NULL) : NULL;
+}
 
-	if(!node)
-		return NULL;
+// numbers ----------------------------------------------------------------------------------------
+// sign, integer part and optional fraction of a number
+struct number_parts
+{
+	boolean negative;
+	const char *int_part, *frac_part;
+	size_t num_int, num_frac;
+};
+
+size_t count_digits(const char* s, size_t n)
+{
+	size_t i;
 
-	pt = get_fix_tag(node, tag);
+	for(i = 0; i < n && s[i] >= '0' && s[i] <= '9'; ++i);
 
-	return pt ? pt->value : NULL;
+	return i;
 }
 
-int get_fix_tag_as_integer(const struct fix_group_node* node, size_t tag, int64_t* p)
+uint64_t parse_digits(const char* s, size_t n)
 {
-	/* From the spec:
-		Sequence of digits without commas or decimals and optional sign character (ASCII characters "-" and "0" - "9" ).
-		The sign character utilizes one byte (i.e. positive int is "99999" while negative int is "-99999").
-		Note that int values may contain leading zeros (e.g. "00023" = "23"). */
+	uint64_t r = 0;
+	const char* const end = s + n;
 
-	int64_t r;
-	boolean positive;
-	const char *s;
+	assert(n <= 19);
 
-	if(!p)
-		return 0;
+	while(s != end)
+		r = 10 * r + (unsigned char)(*s++ - '0');
 
-	s = get_fix_tag_as_string(node, tag);
+	return r;
+}
 
-	if(!s)
-		return 0;
+// splits the value into the parts, returns NO if it is not a number
+static
+boolean read_number(const char* s, size_t n, boolean with_point, struct number_parts* p)
+{
+	p->negative = (n > 0 && *s == '-') ? YES : NO;
 
-	if(*s == '-')
+	if(p->negative)
 	{
 		++s;
-		positive = NO;
+		--n;
 	}
-	else
-		positive = YES;
 
-	if(*s < '0' || *s > '9')
-		return 0;
+	p->int_part = s;
+	p->num_int = count_digits(s, n);
+	p->frac_part = s + p->num_int;
+	p->num_frac = 0;
 
-	r = (unsigned char)(*s - '0');
+	if(p->num_int == 0)
+		return NO;
 
-	for(++s; *s >= '0' && *s <= '9'; ++s)
+	if(p->num_int < n)
 	{
-		const int64_t r2 = r * 10 + (unsigned char)(*s - '0');
+		if(!with_point || s[p->num_int] != '.')
+			return NO;
 
-		if(r2 < r)	// overflow
-			return 0;
+		p->frac_part = s + p->num_int + 1;
+		p->num_frac = count_digits(p->frac_part, n - p->num_int - 1);
 
-		r = r2;
+		if(p->num_int + 1 + p->num_frac != n)
+			return NO;
 	}
 
-	if(*s != 0)
-		return 0;
+	return YES;
+}
 
-	*p = positive ? r : -r;
-	return 1;
+// the integer part followed by num_frac digits of the fraction as an unsigned integer; leading zeros
+// do not count, and up to 19 significant digits always fit into uint64_t, otherwise returns NO
+static
+boolean read_significand(const struct number_parts* p, size_t num_frac, uint64_t* p_value)
+{
+	static const uint64_t pow10[] = {
+		1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+		10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+		10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+	};
+
+	const char *int_part = p->int_part, *frac_part = p->frac_part;
+	size_t num_int = p->num_int;
+
+	for(; num_int > 0 && *int_part == '0'; ++int_part, --num_int);
+
+	if(num_int == 0)
+		for(; num_frac > 0 && *frac_part == '0'; ++frac_part, --num_frac);
+
+	if(num_int + num_frac > 19)
+		return NO;
+
+	*p_value = parse_digits(int_part, num_int) * pow10[num_frac] + parse_digits(frac_part, num_frac);
+	return YES;
+}
+
+// the integer part followed by num_frac digits of the fraction as a signed 64 bit integer;
+// returns NO on overflow, which is exact
+static
+boolean make_integer(const struct number_parts* p, size_t num_frac, int64_t* p_value)
+{
+	static const uint64_t max_value = 9223372036854775807ULL;
+
+	uint64_t r;
+
+	if(!read_significand(p, num_frac, &r) || r > max_value + (p->negative ? 1 : 0))
+		return NO;
+
+	*p_value = (p->negative && r > 0) ? -(int64_t)(r - 1) - 1 : (int64_t)r;
+	return YES;
+}
+
+int get_fix_tag_as_integer(const struct fix_group_node* node, size_t tag, int64_t* p)
+{
+	/* From the spec:
+		Sequence of digits without commas or decimals and optional sign character (ASCII characters "-" and "0" - "9" ).
+		The sign character utilizes one byte (i.e. positive int is "99999" while negative int is "-99999").
+		Note that int values may contain leading zeros (e.g. "00023" = "23"). */
+
+	size_t n;
+	struct number_parts parts;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
+
+	return (s && p && read_number(s, n, NO, &parts) && make_integer(&parts, 0, p)) ? 1 : 0;
 }
 
 int get_fix_tag_as_real(const struct fix_group_node* node, size_t tag, int64_t* p_value)
@@ -188,96 +378,340 @@ int get_fix_tag_as_real(const struct fix_group_node* node, size_t tag, int64_t*
 		leading zeros (e.g. "00023.23" = "23.23") and may contain or omit trailing zeros after the decimal
 		point (e.g. "23.0" = "23.0000" = "23" = "23."). */
 
-	int64_t integer;
-	boolean positive;
-	int num_int, num_frac;	// number of digits in the integer and fractional parts
-	const char *s, *base;
+	size_t n;
+	struct number_parts parts;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
 
-	if(!p_value)
+	if(!s || !p_value || !read_number(s, n, YES, &parts) || parts.num_int + parts.num_frac > 15
+	   || !make_integer(&parts, parts.num_frac, p_value))
 		return -1;
 
-	s = get_fix_tag_as_string(node, tag);
+	return (int)parts.num_frac;
+}
 
-	if(!s)
-		return -1;
+int get_fix_tag_as_decimal(const struct fix_group_node* node, size_t tag, struct fix_decimal* p_value)
+{
+	size_t n, num_frac;
+	struct number_parts parts;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
+
+	if(!s || !p_value || !read_number(s, n, YES, &parts))
+		return 0;
 
-	// sign
-	if(*s == '-')
+	num_frac = parts.num_frac;
+
+	// trailing zeros of the fraction only get dropped if the value does not fit otherwise
+	if(!make_integer(&parts, num_frac, &p_value->mantissa))
 	{
-		++s;
-		positive = NO;
+		for(; num_frac > 0 && parts.frac_part[num_frac - 1] == '0'; --num_frac);
+
+		if(num_frac == parts.num_frac || !make_integer(&parts, num_frac, &p_value->mantissa))
+			return 0;
 	}
-	else
-		positive = YES;
 
-	base = s;
+	p_value->exponent = -(int)num_frac;
+	return 1;
+}
 
-	// integer part
-	if(*s < '0' || *s > '9')
-		return -1;
+// decimal to double conversion: the exact fast path for small values, then the Eisel-Lemire algorithm
+// (D. Lemire, "Number Parsing at a Gigabyte per Second"; N. Tao, "The Eisel-Lemire ParseNumberF64 Algorithm"),
+// and strtod() in the "C" locale for the few cases neither can decide
+#define MIN_POW10_128	(-64)
+
+// 128 bit mantissas of the powers of ten from 1e-64 to 1e0 as { high, low }, rounded down
+static const uint64_t pow10_128[][2] = {
+	{ 0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL },	// 1e-64
+	{ 0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL },	// 1e-63
+	{ 0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL },	// 1e-62
+	{ 0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL },	// 1e-61
+	{ 0xCDB02555653131B6ULL, 0x3792F412CB06794DULL },	// 1e-60
+	{ 0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL },	// 1e-59
+	{ 0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL },	// 1e-58
+	{ 0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL },	// 1e-57
+	{ 0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL },	// 1e-56
+	{ 0x9CED737BB6C4183DULL, 0x55464DD69685606BULL },	// 1e-55
+	{ 0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL },	// 1e-54
+	{ 0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL },	// 1e-53
+	{ 0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL },	// 1e-52
+	{ 0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL },	// 1e-51
+	{ 0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL },	// 1e-50
+	{ 0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL },	// 1e-49
+	{ 0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL },	// 1e-48
+	{ 0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL },	// 1e-47
+	{ 0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL },	// 1e-46
+	{ 0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL },	// 1e-45
+	{ 0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL },	// 1e-44
+	{ 0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL },	// 1e-43
+	{ 0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL },	// 1e-42
+	{ 0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL },	// 1e-41
+	{ 0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL },	// 1e-40
+	{ 0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL },	// 1e-39
+	{ 0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL },	// 1e-38
+	{ 0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL },	// 1e-37
+	{ 0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL },	// 1e-36
+	{ 0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL },	// 1e-35
+	{ 0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL },	// 1e-34
+	{ 0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL },	// 1e-33
+	{ 0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL },	// 1e-32
+	{ 0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL },	// 1e-31
+	{ 0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL },	// 1e-30
+	{ 0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL },	// 1e-29
+	{ 0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL },	// 1e-28
+	{ 0x9E74D1B791E07E48ULL, 0x775EA264CF55347DULL },	// 1e-27
+	{ 0xC612062576589DDAULL, 0x95364AFE032A819DULL },	// 1e-26
+	{ 0xF79687AED3EEC551ULL, 0x3A83DDBD83F52204ULL },	// 1e-25
+	{ 0x9ABE14CD44753B52ULL, 0xC4926A9672793542ULL },	// 1e-24
+	{ 0xC16D9A0095928A27ULL, 0x75B7053C0F178293ULL },	// 1e-23
+	{ 0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6338ULL },	// 1e-22
+	{ 0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E03ULL },	// 1e-21
+	{ 0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF584ULL },	// 1e-20
+	{ 0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E5ULL },	// 1e-19
+	{ 0x9392EE8E921D5D07ULL, 0x3AFF322E62439FCFULL },	// 1e-18
+	{ 0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C2ULL },	// 1e-17
+	{ 0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B3ULL },	// 1e-16
+	{ 0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A10ULL },	// 1e-15
+	{ 0xB424DC35095CD80FULL, 0x538484C19EF38C94ULL },	// 1e-14
+	{ 0xE12E13424BB40E13ULL, 0x2865A5F206B06FB9ULL },	// 1e-13
+	{ 0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D3ULL },	// 1e-12
+	{ 0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D748ULL },	// 1e-11
+	{ 0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1BULL },	// 1e-10
+	{ 0x89705F4136B4A597ULL, 0x31680A88F8953030ULL },	// 1e-9
+	{ 0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3DULL },	// 1e-8
+	{ 0xD6BF94D5E57A42BCULL, 0x3D32907604691B4CULL },	// 1e-7
+	{ 0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B10FULL },	// 1e-6
+	{ 0xA7C5AC471B478423ULL, 0x0FCF80DC33721D53ULL },	// 1e-5
+	{ 0xD1B71758E219652BULL, 0xD3C36113404EA4A8ULL },	// 1e-4
+	{ 0x83126E978D4FDF3BULL, 0x645A1CAC083126E9ULL },	// 1e-3
+	{ 0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A3ULL },	// 1e-2
+	{ 0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCCULL },	// 1e-1
+	{ 0x8000000000000000ULL, 0x0000000000000000ULL },	// 1e0
+};
+
+// full product of two 64 bit numbers, returns the high half
+static
+uint64_t multiply_64x64(uint64_t a, uint64_t b, uint64_t* p_low)
+{
+#if defined(__SIZEOF_INT128__)
+	const unsigned __int128 r = (unsigned __int128)a * b;
+
+	*p_low = (uint64_t)r;
+	return (uint64_t)(r >> 64);
+#elif defined(_M_X64)
+	uint64_t high;
+
+	*p_low = _umul128(a, b, &high);
+	return high;
+#else
+	const uint64_t a_lo = (uint32_t)a, a_hi = a >> 32, b_lo = (uint32_t)b, b_hi = b >> 32;
+	const uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+	const uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+
+	*p_low = (mid << 32) | (uint32_t)p0;
+	return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+}
 
-	integer = (unsigned char)(*s - '0');
+// x != 0
+static
+unsigned count_leading_zeros(uint64_t x)
+{
+#if defined(__GNUC__)
+	return (unsigned)__builtin_clzll(x);
+#elif defined(_M_X64)
+	unsigned long i;
+
+	_BitScanReverse64(&i, x);
+	return 63u - (unsigned)i;
+#else
+	unsigned long i;
+
+	if(_BitScanReverse(&i, (unsigned long)(x >> 32)))
+		return 31u - (unsigned)i;
+
+	_BitScanReverse(&i, (unsigned long)x);
+	return 63u - (unsigned)i;
+#endif
+}
+
+// correctly rounded w * 10^q for w != 0 and MIN_POW10_128 <= q <= 0, or NO if the result cannot be decided
+static
+boolean eisel_lemire(uint64_t w, int q, boolean negative, double* p_value)
+{
+	const uint64_t* const pow10 = pow10_128[q - MIN_POW10_128];
+	const unsigned clz = count_leading_zeros(w);
+	uint64_t hi, lo, mantissa, msb, bits;
 
-	for(++s; *s >= '0' && *s <= '9'; ++s)
-		integer = integer * 10 + (unsigned char)(*s - '0');
+	// biased binary exponent, floor(q * log2(10)) for q <= 0
+	uint64_t exp2 = (uint64_t)(1023 + 64 - (int)((217706u * (uint32_t)-q + 65535u) >> 16)) - clz;
 
-	num_int = s - base;
+	w <<= clz;
+	hi = multiply_64x64(w, pow10[0], &lo);
 
-	if(*s == '.')	// decimal point
+	// the power of ten is truncated, so the true product may carry into the bits that matter;
+	// the low half of the power settles it in all but a few cases
+	if((hi & 0x1FF) == 0x1FF && lo + w < w)
 	{
-		// fractional part
-		for(base = ++s; *s >= '0' && *s <= '9'; ++s)
-			integer = integer * 10 + (unsigned char)(*s - '0');
+		uint64_t y_lo;
+		const uint64_t y_hi = multiply_64x64(w, pow10[1], &y_lo);
+		const uint64_t merged_lo = lo + y_hi, merged_hi = hi + (merged_lo < lo ? 1 : 0);
 
-		num_frac = s - base;
+		if((merged_hi & 0x1FF) == 0x1FF && merged_lo + 1 == 0 && y_lo + w < w)
+			return NO;
+
+		hi = merged_hi;
+		lo = merged_lo;
 	}
-	else
-		num_frac = 0;
 
-	if(*s != 0 || num_int + num_frac > 15)
-		return -1;
+	// 54 bits of mantissa
+	msb = hi >> 63;
+	mantissa = hi >> (msb + 9);
+	exp2 -= 1 ^ msb;
 
-	// all done
-	*p_value = positive ? integer : -integer;
+	// half-way between two doubles, the rounding cannot be decided
+	if(lo == 0 && (hi & 0x1FF) == 0 && (mantissa & 3) == 1)
+		return NO;
 
-	return num_frac;
+	// round to 53 bits
+	mantissa += mantissa & 1;
+	mantissa >>= 1;
+
+	if(mantissa >> 53)
+	{
+		mantissa >>= 1;
+		++exp2;
+	}
+
+	if(exp2 - 1 >= 0x7FF - 1)	// subnormal or infinity
+		return NO;
+
+	bits = (exp2 << 52) | (mantissa & 0x000FFFFFFFFFFFFFULL) | (negative ? 0x8000000000000000ULL : 0);
+	memcpy(p_value, &bits, sizeof(bits));
+	return YES;
 }
 
-int get_fix_tag_as_double(const struct fix_group_node* node, size_t tag, double* p_value)
+// strtod() in the "C" locale, so the decimal point does not depend on setlocale(); the locale
+// object gets created once, on the first use from any thread, and lives until the process exits
+#ifdef _WIN32
+
+static _locale_t c_locale;
+static INIT_ONCE c_locale_once = INIT_ONCE_STATIC_INIT;
+
+static
+BOOL CALLBACK create_c_locale(PINIT_ONCE once, PVOID param, PVOID* context)
 {
-	static const double mult[] = { 0., 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8, 1e-9, 1e-10, 1e-11, 1e-12, 1e-13, 1e-14, 1e-15 };
+	(void)once;
+	(void)param;
+	(void)context;
 
-	int64_t val;
-	int num_frac;
+	c_locale = _create_locale(LC_NUMERIC, "C");
+	return TRUE;
+}
+
+static
+double strtod_c(const char* s, char** end)
+{
+	InitOnceExecuteOnce(&c_locale_once, create_c_locale, NULL, NULL);
+
+	if(!c_locale)
+	{
+		*end = (char*)s;
+		return 0.;
+	}
+
+	return _strtod_l(s, end, c_locale);
+}
+
+#else	// POSIX
+
+static locale_t c_locale;
+static pthread_once_t c_locale_once = PTHREAD_ONCE_INIT;
+
+static
+void create_c_locale()
+{
+	c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+}
+
+static
+double strtod_c(const char* s, char** end)
+{
+	pthread_once(&c_locale_once, create_c_locale);
 
-	if(!p_value)
+	if(!c_locale)
+	{
+		*end = (char*)s;
+		return 0.;
+	}
+
+	return strtod_l(s, end, c_locale);
+}
+
+#endif	// POSIX
+
+int get_fix_tag_as_double(const struct fix_group_node* node, size_t tag, double* p_value)
+{
+	// powers of ten represented exactly
+	static const double pow10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	size_t n, num_frac;
+	uint64_t w;
+	double r;
+	char* end;
+	struct number_parts parts;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
+
+	if(!s || !p_value || !read_number(s, n, YES, &parts))
 		return -1;
 
-	num_frac = get_fix_tag_as_real(node, tag, &val);
+	// trailing zeros of the fraction do not change the value
+	for(num_frac = parts.num_frac; num_frac > 0 && parts.frac_part[num_frac - 1] == '0'; --num_frac);
+
+	if(read_significand(&parts, num_frac, &w))
+	{
+		if(w == 0)
+		{
+			*p_value = parts.negative ? -0. : 0.;
+			return (int)parts.num_frac;
+		}
+
+		// both operands are exact, so the quotient is correctly rounded
+		if(w <= (1ULL << 53) && num_frac < sizeof(pow10)/sizeof(pow10[0]))
+		{
+			*p_value = parts.negative ? -((double)w / pow10[num_frac]) : (double)w / pow10[num_frac];
+			return (int)parts.num_frac;
+		}
+
+		if(num_frac <= (size_t)-MIN_POW10_128 && eisel_lemire(w, -(int)num_frac, parts.negative, p_value))
+			return (int)parts.num_frac;
+	}
 
-	assert(num_frac <= 15);
+	// the value is NUL-terminated
+	r = strtod_c(s, &end);
 
-	if(num_frac > 0)
-		*p_value = mult[num_frac] * (double)val;
-	else if(num_frac == 0)
-		*p_value = (double)val;
+	if(end != s + n)
+		return -1;
 
-	return num_frac;
+	*p_value = r;
+	return (int)parts.num_frac;
 }
 
 int get_fix_tag_as_boolean(const struct fix_group_node* node, size_t tag)
 {
-	const struct fix_tag* pt;
+	size_t length;
+	const char* value;
 
 	if(!node)
 		return -1;
 
-	pt = get_fix_tag(node, tag);
+	value = get_fix_tag_value(node, tag, &length);
 
-	if(!pt || !pt->value || pt->length != 1)
+	if(!value || length != 1)
 		return -1;
 
-	switch(*pt->value)
+	switch(*value)
 	{
 	case 'Y':
 		return 1;
@@ -289,143 +723,335 @@ int get_fix_tag_as_boolean(const struct fix_group_node* node, size_t tag)
 }
 
 // time conversion functions
-#define IS_DIGIT(c)		((c) >= '0' && (c) <= '9')
-#define DIGIT_TO_INT(c)	((unsigned char)((c) - '0'))
-
-#define READ_2_DIGITS(r)	\
-	if(!IS_DIGIT(s[0]) || !IS_DIGIT(s[1]))	\
-		return (int64_t)-1;	\
-	r = 10 * DIGIT_TO_INT(s[0]) + DIGIT_TO_INT(s[1]);	\
-	s += 2
-
-#define READ_3_DIGITS(r)	\
-	if(!IS_DIGIT(s[0]) || !IS_DIGIT(s[1]) || !IS_DIGIT(s[2]))	\
-		return (int64_t)-1;	\
-	r = 100 * DIGIT_TO_INT(s[0]) + 10 * DIGIT_TO_INT(s[1]) + DIGIT_TO_INT(s[2]);	\
-	s += 3
-
-#define READ_4_DIGITS(r)	\
-	if(!IS_DIGIT(s[0]) || !IS_DIGIT(s[1]) || !IS_DIGIT(s[2]) || !IS_DIGIT(s[3]))	\
-		return (int64_t)-1;	\
-	r = 1000 * DIGIT_TO_INT(s[0]) + 100 * DIGIT_TO_INT(s[1]) + 10 * DIGIT_TO_INT(s[2]) + DIGIT_TO_INT(s[3]);	\
-	s += 4
-
-#define MATCH(c)	\
-	if(*s++ != c)	\
-		return (int64_t)-1
+// reads n decimal digits; a non-digit byte sets *p_bad to 1 instead of branching out
+static
+uint32_t read_digits(const char* s, size_t n, unsigned* p_bad)
+{
+	const char* const end = s + n;
+	uint32_t r = 0;
+	unsigned bad = 0;
 
-#ifdef _WIN32
+	for(; s < end; ++s)
+	{
+		const uint32_t d = (uint32_t)(unsigned char)*s - '0';
 
-#define STRICT
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
+		bad |= (d > 9);
+		r = 10 * r + d;
+	}
 
-int64_t get_fix_tag_as_utc_timestamp(const struct fix_group_node* node, size_t tag)
+	*p_bad |= bad;
+	return r;
+}
+
+static
+boolean is_leap_year(uint32_t year)
 {
-	/* From the spec:
-		String field representing Time/date combination represented in UTC (Universal Time Coordinated, also known as "GMT")
-		in either YYYYMMDD-HH:MM:SS (whole seconds) or YYYYMMDD-HH:MM:SS.sss (milliseconds) format, colons, dash, and period required.
+	return (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) ? YES : NO;
+}
 
-		Valid values:
-		* YYYY = 0000-9999, MM = 01-12, DD = 01-31, HH = 00-23, MM = 00-59, SS = 00-60 (60 only if UTC leap second) (without milliseconds).
-		* YYYY = 0000-9999, MM = 01-12, DD = 01-31, HH = 00-23, MM = 00-59, SS = 00-60 (60 only if UTC leap second), sss=000-999 (indicating milliseconds).
-	*/
+static
+boolean is_valid_date(uint32_t year, uint32_t month, uint32_t day)
+{
+	static const unsigned char month_days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
 
-	SYSTEMTIME st;
-	FILETIME ft;
-	const char* s = get_fix_tag_as_string(node, tag);
+	return (month - 1 <= 11 && day - 1 < month_days[month - 1] + ((month == 2 && is_leap_year(year)) ? 1u : 0u)) ? YES : NO;
+}
 
-	if(!s)
-		return (int64_t)-1;
+// number of days since 1970-01-01 for the given proleptic Gregorian date
+// (H. Hinnant, "chrono-Compatible Low-Level Date Algorithms")
+static
+int64_t days_from_civil(uint32_t year, uint32_t month, uint32_t day)
+{
+	const int64_t y = (int64_t)year - (month <= 2 ? 1 : 0);
+	const int64_t era = (y >= 0 ? y : y - 399) / 400;
+	const uint32_t yoe = (uint32_t)(y - era * 400);									// [0, 399]
+	const uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;	// [0, 365]
+	const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;						// [0, 146096]
+
+	return era * 146097 + (int64_t)doe - 719468;
+}
+
+// YYYYMMDD reader, gives the number of days since 1970-01-01
+static
+boolean read_date(const char* s, int64_t* p_days)
+{
+	unsigned bad = 0;
+	const uint32_t year = read_digits(s, 4, &bad);
+	const uint32_t month = read_digits(s + 4, 2, &bad);
+	const uint32_t day = read_digits(s + 6, 2, &bad);
+
+	if(bad || !is_valid_date(year, month, day))
+		return NO;
 
-	READ_4_DIGITS(st.wYear);
-	READ_2_DIGITS(st.wMonth);
-	READ_2_DIGITS(st.wDay);
-	MATCH('-');
-	READ_2_DIGITS(st.wHour);
-	MATCH(':');
-	READ_2_DIGITS(st.wMinute);
-	MATCH(':');
-	READ_2_DIGITS(st.wSecond);
-
-	switch(*s++)
+	*p_days = days_from_civil(year, month, day);
+	return YES;
+}
+
+// date cache: the last date seen by a time conversion function, as consecutive messages nearly always share it;
+// the cache is per thread, so the conversions may run concurrently
+struct date_cache_entry
+{
+	char date[8];		// YYYYMMDD, never matches while zero-filled
+	int64_t days;		// days since 1970-01-01
+};
+
+struct date_cache
+{
+	struct date_cache_entry utc;	// date part of UTCTimestamp and TZTimestamp
+	struct date_cache_entry date;	// date-only fields, LocalMktDate with an offset and UTCDateOnly
+};
+
+static THREAD_LOCAL struct date_cache dates;
+
+// YYYYMMDD reader with the date cache; an invalid date never gets cached
+static
+boolean read_cached_date(struct date_cache_entry* entry, const char* s, int64_t* p_days)
+{
+	if(memcmp(entry->date, s, sizeof(entry->date)) == 0)
 	{
-	case 0:
-		st.wMilliseconds = 0;
-		break;
-	case '.':
-		READ_3_DIGITS(st.wMilliseconds);
-		MATCH(0);
-		break;
-	default:
-		return (int64_t)-1;
+		*p_days = entry->days;
+		return YES;
 	}
 
-	st.wDayOfWeek = 0;
+	if(!read_date(s, p_days))
+		return NO;
 
-	return SystemTimeToFileTime(&st, &ft) ?
-		(((int64_t)ft.dwHighDateTime << 32) | (int64_t)ft.dwLowDateTime)
-		:
-		(int64_t)-1;
+	memcpy(entry->date, s, sizeof(entry->date));
+	entry->days = *p_days;
+	return YES;
 }
 
-#else	// Linux
+// HH:MM:SS reader with optional .sss, .ssssss or .sssssssss fraction;
+// returns the number of fraction digits or -1 on error
+static
+int read_time(const char* s, size_t n, int64_t* p_sec, uint32_t* p_nsec)
+{
+	static const uint32_t frac_scale[] = { 0, 1000000, 1000, 1 };
 
-int64_t get_fix_tag_as_utc_timestamp(const struct fix_group_node* node, size_t tag)
+	uint32_t hour, minute, second, frac = 0;
+	unsigned bad = 0;
+	int num_frac;
+
+	switch(n)
+	{
+		case 8:		num_frac = 0;	break;
+		case 12:	num_frac = 3;	break;
+		case 15:	num_frac = 6;	break;
+		case 18:	num_frac = 9;	break;
+		default:	return -1;
+	}
+
+	if(s[2] != ':' || s[5] != ':' || (num_frac > 0 && s[8] != '.'))
+		return -1;
+
+	hour = read_digits(s, 2, &bad);
+	minute = read_digits(s + 3, 2, &bad);
+	second = read_digits(s + 6, 2, &bad);
+
+	if(num_frac > 0)
+		frac = read_digits(s + 9, (size_t)num_frac, &bad);
+
+	if(bad || hour > 23 || minute > 59 || second > 60)	// 60 only if UTC leap second
+		return -1;
+
+	*p_sec = (int64_t)(hour * 3600 + minute * 60 + second);
+	*p_nsec = frac * frac_scale[num_frac / 3];
+	return num_frac;
+}
+
+// UTCTimestamp reader: YYYYMMDD-HH:MM:SS with optional .sss, .ssssss or .sssssssss fraction;
+// returns the number of fraction digits or -1 on error
+static
+int read_utc_timestamp(const char* s, size_t n, int64_t* p_sec, uint32_t* p_nsec)
 {
 	/* From the spec:
 		String field representing Time/date combination represented in UTC (Universal Time Coordinated, also known as "GMT")
-		in either YYYYMMDD-HH:MM:SS (whole seconds) or YYYYMMDD-HH:MM:SS.sss (milliseconds) format, colons, dash, and period required.
+		in either YYYYMMDD-HH:MM:SS (whole seconds) or YYYYMMDD-HH:MM:SS.sss* format, colons, dash, and period required.
 
 		Valid values:
-		* YYYY = 0000-9999, MM = 01-12, DD = 01-31, HH = 00-23, MM = 00-59, SS = 00-60 (60 only if UTC leap second) (without milliseconds).
-		* YYYY = 0000-9999, MM = 01-12, DD = 01-31, HH = 00-23, MM = 00-59, SS = 00-60 (60 only if UTC leap second), sss=000-999 (indicating milliseconds).
+		YYYY = 0000-9999, MM = 01-12, DD = 01-31, HH = 00-23, MM = 00-59, SS = 00-60 (60 only if UTC leap second),
+		sss* fractions of seconds: milliseconds (.sss), microseconds (.ssssss) or nanoseconds (.sssssssss).
 	*/
 
-	struct tm t;
-	time_t sec;
-	int64_t frac;
-	const char* s = get_fix_tag_as_string(node, tag);
+	int64_t days;
+	int num_frac;
 
-	if(!s)
-		return (int64_t)-1;
+	if(n < 9 || s[8] != '-')
+		return -1;
+
+	// only the time gets parsed if the date is the same as last time
+	num_frac = read_time(s + 9, n - 9, p_sec, p_nsec);
+
+	if(num_frac < 0 || !read_cached_date(&dates.utc, s, &days))
+		return -1;
+
+	*p_sec += days * 86400;
+	return num_frac;
+}
+
+// stores the time as nanoseconds, if they fit into int64_t (roughly years 1677 to 2262)
+static
+boolean to_nanoseconds(int64_t sec, uint32_t nsec, int64_t* p_value)
+{
+	static const int64_t max_sec = 9223372036LL, max_nsec = 854775807LL;
+
+	if(sec < -max_sec || sec > max_sec || (sec == max_sec && nsec > max_nsec))
+		return NO;
+
+	*p_value = sec * 1000000000 + nsec;
+	return YES;
+}
+
+int get_fix_tag_as_utc_timestamp_ns(const struct fix_group_node* node, size_t tag, int64_t* p_value)
+{
+	size_t n;
+	int64_t sec;
+	uint32_t nsec;
+	int num_frac;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
+
+	if(!s || !p_value)
+		return -1;
 
-	READ_4_DIGITS(t.tm_year);
-	READ_2_DIGITS(t.tm_mon);
-	READ_2_DIGITS(t.tm_mday);
-	MATCH('-');
-	READ_2_DIGITS(t.tm_hour);
-	MATCH(':');
-	READ_2_DIGITS(t.tm_min);
-	MATCH(':');
-	READ_2_DIGITS(t.tm_sec);
-
-	// correction
-	t.tm_year -= 1900;
-	t.tm_mon -= 1;
-	t.tm_yday = t.tm_isdst = 0;
-
-	// convert
-	sec = timegm(&t);
-
-	if(sec == (time_t)-1)
+	num_frac = read_utc_timestamp(s, n, &sec, &nsec);
+
+	return (num_frac >= 0 && to_nanoseconds(sec, nsec, p_value)) ? num_frac : -1;
+}
+
+int64_t get_fix_tag_as_utc_timestamp(const struct fix_group_node* node, size_t tag)
+{
+#ifdef _WIN32
+	static const int64_t epoch = 11644473600LL;	// seconds from 1601-01-01 to 1970-01-01
+#else
+	static const int64_t epoch = 0;
+#endif
+
+	size_t n;
+	int64_t sec;
+	uint32_t nsec;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
+
+	if(!s || read_utc_timestamp(s, n, &sec, &nsec) < 0)
 		return (int64_t)-1;
 
-	// milliseconds
-	switch(*s++)
+	return (sec + epoch) * 10000000 + nsec / 100;	// 100 ns intervals, negative before the epoch
+}
+
+int get_fix_tag_as_utc_time_only(const struct fix_group_node* node, size_t tag, int64_t* p_value)
+{
+	/* From the spec:
+		String field representing Time-only represented in UTC (Universal Time Coordinated, also known as "GMT")
+		in either HH:MM:SS (whole seconds) or HH:MM:SS.sss* format, colons, and period required.
+	*/
+
+	size_t n;
+	int64_t sec;
+	uint32_t nsec;
+	int num_frac;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
+
+	if(!s || !p_value)
+		return -1;
+
+	num_frac = read_time(s, n, &sec, &nsec);
+
+	if(num_frac >= 0)
+		*p_value = sec * 1000000000 + nsec;
+
+	return num_frac;
+}
+
+int get_fix_tag_as_tz_timestamp(const struct fix_group_node* node, size_t tag, int64_t* p_value)
+{
+	/* From the spec:
+		String field representing a time/date combination representing local time with an offset to UTC to allow
+		identification of local time and timezone offset of that time. The representation is based on ISO 8601.
+		Format is YYYYMMDD-HH:MM:SS.sss*[Z | [ + | - hh[:mm]]] where YYYY = 0000 to 9999, MM = 01-12, DD = 01-31,
+		HH = 00-23 hours, MM = 00-59 minutes, SS = 00-59 seconds, hh offset hours, mm = 00-59 offset minutes,
+		sss* fractions of seconds. Seconds and their fractions are optional, e.g. 20060901-07:39Z.
+	*/
+
+	size_t n, tz;
+	int64_t sec, days, offset = 0;
+	uint32_t nsec = 0;
+	int num_frac = 0;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
+
+	if(!s || !p_value || n < 14 || s[8] != '-')
+		return -1;
+
+	// time zone designator, if any
+	for(tz = 14; tz < n && s[tz] != 'Z' && s[tz] != '+' && s[tz] != '-'; ++tz)
+		;
+
+	if(tz < n)
 	{
-	case 0:
-		return (int64_t)sec * 10000000;	// 100 ns intervals
-	case '.':
-		READ_3_DIGITS(frac);
-		MATCH(0);
-		return (int64_t)sec * 10000000 + frac * 10000;	// 100 ns intervals
-	default:
-		return (int64_t)-1;
+		unsigned bad = 0;
+		uint32_t hours = 0, minutes = 0;
+
+		switch(n - tz)
+		{
+			case 1:		// Z
+				break;
+			case 3:		// +hh
+				hours = read_digits(s + tz + 1, 2, &bad);
+				break;
+			case 6:		// +hh:mm
+				hours = read_digits(s + tz + 1, 2, &bad);
+				minutes = read_digits(s + tz + 4, 2, &bad);
+				bad |= (s[tz + 3] != ':');
+				break;
+			default:
+				return -1;
+		}
+
+		if(bad || (s[tz] == 'Z') != (n - tz == 1) || hours > 23 || minutes > 59)
+			return -1;
+
+		offset = (int64_t)(hours * 3600 + minutes * 60);
+
+		if(s[tz] == '-')
+			offset = -offset;
 	}
+
+	// HH:MM, or HH:MM:SS with optional fraction
+	if(tz == 14)
+	{
+		unsigned bad = 0;
+		const uint32_t hour = read_digits(s + 9, 2, &bad), minute = read_digits(s + 12, 2, &bad);
+
+		if(bad || s[11] != ':' || hour > 23 || minute > 59)
+			return -1;
+
+		sec = (int64_t)(hour * 3600 + minute * 60);
+	}
+	else if((num_frac = read_time(s + 9, tz - 9, &sec, &nsec)) < 0)
+		return -1;
+
+	if(!read_cached_date(&dates.utc, s, &days))
+		return -1;
+
+	return to_nanoseconds(days * 86400 + sec - offset, nsec, p_value) ? num_frac : -1;
+}
+
+// YYYYMMDD tag value reader, using the date cache of date-only fields
+static
+boolean read_date_only(const struct fix_group_node* node, size_t tag, int64_t* p_days)
+{
+	size_t n;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
+
+	return (s && n == 8 && read_cached_date(&dates.date, s, p_days)) ? YES : NO;
 }
 
-#endif	// Linux
+// seconds since 1970-01-01 as time_t, or (time_t)-1 if they do not fit (after 2038 with 32 bit time_t)
+static
+time_t to_time_t(int64_t sec)
+{
+	const time_t t = (time_t)sec;
+
+	return ((int64_t)t == sec) ? t : (time_t)-1;
+}
 
 time_t get_fix_tag_as_local_mkt_date(const struct fix_group_node* node, size_t tag)
 {
@@ -435,21 +1061,89 @@ time_t get_fix_tag_as_local_mkt_date(const struct fix_group_node* node, size_t t
 		YYYY = 0000-9999, MM = 01-12, DD = 01-31.
 	*/
 
+	size_t n;
+	unsigned bad = 0;
+	uint32_t year, month, day;
 	struct tm t;
-	const char* s = get_fix_tag_as_string(node, tag);
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
 
-	if(!s)
-		return (int64_t)-1;
+	if(!s || n != 8)
+		return (time_t)-1;
+
+	year = read_digits(s, 4, &bad);
+	month = read_digits(s + 4, 2, &bad);
+	day = read_digits(s + 6, 2, &bad);
 
-	READ_4_DIGITS(t.tm_year);
-	READ_2_DIGITS(t.tm_mon);
-	READ_2_DIGITS(t.tm_mday);
-	MATCH(0);
+	if(bad || !is_valid_date(year, month, day))
+		return (time_t)-1;
 
-	t.tm_year -= 1900;
-	t.tm_mon -= 1;
-	t.tm_hour = t.tm_min = t.tm_sec = t.tm_yday = t.tm_isdst = 0;
+	// local midnight in the time zone of the process, mktime() fails if it does not fit into time_t
+	ZERO_FILL(&t);
+	t.tm_year = (int)year - 1900;
+	t.tm_mon = (int)month - 1;
+	t.tm_mday = (int)day;
+	t.tm_isdst = -1;
 
 	return mktime(&t);
 }
 
+time_t get_fix_tag_as_local_mkt_date_tz(const struct fix_group_node* node, size_t tag, int utc_offset)
+{
+	int64_t days;
+
+	return read_date_only(node, tag, &days) ? to_time_t(days * 86400 - (int64_t)utc_offset * 60) : (time_t)-1;
+}
+
+time_t get_fix_tag_as_utc_date_only(const struct fix_group_node* node, size_t tag)
+{
+	/* From the spec:
+		Date represented in UTC (Universal Time Coordinated, also known as "GMT") in YYYYMMDD format.
+	*/
+
+	int64_t days;
+
+	return read_date_only(node, tag, &days) ? to_time_t(days * 86400) : (time_t)-1;
+}
+
+int get_fix_tag_as_month_year(const struct fix_group_node* node, size_t tag, struct fix_month_year* p_value)
+{
+	/* From the spec:
+		String field representing month of a year. An optional day of the month can be appended or an optional
+		week code. Valid formats: YYYYMM, YYYYMMDD, YYYYMMWW, where YYYY = 0000-9999, MM = 01-12, DD = 01-31,
+		WW = w1, w2, w3, w4, w5.
+	*/
+
+	size_t n;
+	unsigned bad = 0;
+	uint32_t year, month, day = 0, week = 0;
+	const char* const s = node ? get_fix_tag_value(node, tag, &n) : NULL;
+
+	if(!s || !p_value || (n != 6 && n != 8))
+		return 0;
+
+	year = read_digits(s, 4, &bad);
+	month = read_digits(s + 4, 2, &bad);
+
+	if(n == 8)
+	{
+		if(s[6] == 'w')
+		{
+			week = read_digits(s + 7, 1, &bad);
+			bad |= (week - 1 > 4);
+		}
+		else
+		{
+			day = read_digits(s + 6, 2, &bad);
+			bad |= !is_valid_date(year, month, day);
+		}
+	}
+
+	if(bad || month - 1 > 11)
+		return 0;
+
+	p_value->year = (unsigned short)year;
+	p_value->month = (unsigned char)month;
+	p_value->day = (unsigned char)day;
+	p_value->week = (unsigned char)week;
+	return 1;
+}
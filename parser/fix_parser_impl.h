@@ -31,10 +31,12 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 #define SPRINTF_S sprintf_s
 #define VSPRINTF_S vsprintf_s
 #define NOINLINE __declspec(noinline)
+#define THREAD_LOCAL __declspec(thread)
 #else
 #define SPRINTF_S snprintf
 #define VSPRINTF_S vsnprintf
 #define NOINLINE __attribute__((noinline))
+#define THREAD_LOCAL __thread
 #endif
 
 #include "../fix_parser.h"
@@ -50,64 +52,217 @@ struct string_buffer
 
 void string_buffer_ensure_capacity(struct string_buffer* s, size_t n);
 char append_bytes_to_string_buffer_with_checksum(struct string_buffer* sb, const char* s, size_t n);
+char get_checksum(const char* s, size_t n);
+void append_bytes_to_string_buffer(struct string_buffer* s, const char* bytes, size_t n);
 void copy_bytes_to_string_buffer(struct string_buffer* s, const char* bytes, size_t n);
 void set_buffer_empty(struct string_buffer* s);
 
+// memory arena: bump allocator for per-message data, released all at once ------------------------
+#define ARENA_BLOCK_SIZE 65536	// larger requests get blocks of their own size
+
+struct arena_block;
+
+struct arena
+{
+	struct arena_block *first, *current;
+	size_t used;
+};
+
+// returns zero-filled memory, or NULL if the size overflows or malloc() fails
+void* arena_alloc(struct arena* a, size_t n);
+void reset_arena(struct arena* a);
+void free_arena(struct arena* a);
+
 // FIX message node -------------------------------------------------------------------------------
+#define TEST_BIT(bits, tag)	(((bits)[(tag) >> 3] >> ((tag) & 7)) & 1)
+
+// tag storage slot, 16 bytes; the slot is in use only if its generation matches the generation of the node,
+// so the node gets emptied in O(1) by moving on to the next generation
+struct tag_slot
+{
+	uint32_t tag;
+	uint32_t length;		// value length, or number of nodes for a group tag
+	uint32_t offset;		// value offset from the node base, or GROUP_OFFSET for a group tag
+	uint16_t generation;
+	uint16_t index;			// order of addition, index in node->tags
+};
+
+#define GROUP_OFFSET 0x80000000u
+
 struct fix_group_node
 {
-	size_t size, cap_index;
-	struct fix_tag* buff;
-	struct fix_group_node* next;
+	size_t size, hash_size, cap_index;
+	uint16_t generation;
+	const char* base;			// start of the message bytes
+	struct fix_tag* tags;		// struct fix_tag records in the order of addition, i.e. the wire order
+	size_t tags_capacity;
+	struct tag_slot* buff;		// hash table
+	const struct fix_node_table* table;	// node table with ranks, or NULL; valid tags below table->max_tag
+										// are stored in slots[], indexed by the rank of the tag
+	struct tag_slot* slots;
+	size_t num_slots;
+	struct fix_group_node* next;	// the nodes following the first one in a group are laid out contiguously
+	size_t group_size;			// number of nodes in the group, first node only
+	struct lazy_group* lazy;	// groups of the node not built yet, in the lazy groups mode
 };
 
-struct fix_group_node* alloc_group_node();
+// group nodes come from the message arena and are never freed individually, while the message root node
+// keeps its hash table and tag records on the heap (add_fix_tag() with a NULL arena) and gets reused;
+// alloc_group_nodes() returns an array of n linked nodes sharing the message bytes with the node origin,
+// or NULL if out of memory
+struct fix_group_node* alloc_group_nodes(struct arena* arena, const struct fix_node_table* table, size_t n, const struct fix_group_node* origin);
+void init_root_node(struct fix_group_node* pnode, const struct fix_node_table* table, const char* base);
 void clear_group_node(struct fix_group_node* pnode);
 void set_group_node_empty(struct fix_group_node* pnode);
-struct fix_tag* add_fix_tag(struct fix_group_node* pnode, const struct fix_tag* new_tag);
+
+// adds the tag, or the group tag with new_tag->value == NULL and new_tag->group set to its first node, allocating
+// from the arena, or from the heap if the arena is NULL (root node); returns the slot of the tag, which is
+// an existing one for a duplicate tag (the node size does not change then), or NULL if the node is full or out of memory
+const struct tag_slot* add_fix_tag(struct fix_group_node* pnode, const struct fix_tag* new_tag, struct arena* arena);
 
 // FIX message ------------------------------------------------------------------------------------
 struct real_fix_message
 {
 	struct fix_message properties;
 	struct fix_group_node root;
+	struct arena* arena;	// group nodes, on the heap so that it stays in place when the message moves to a batch
+	struct string_buffer raw;	// message bytes in the raw messages mode
 	boolean complete;
 };
 
 void set_message_empty(struct real_fix_message* msg);
 
+// batch of parsed messages, each with its own storage
+struct batch_message
+{
+	struct real_fix_message message;
+	struct string_buffer buffer;
+};
+
+struct message_batch
+{
+	size_t size, capacity;
+	struct batch_message* messages;
+	const struct fix_message** list;
+};
+
 // splitter ---------------------------------------------------------------------------------------
 struct splitter_data
 {
 	int state;
 	size_t byte_counter, counter;
+	size_t message_bytes;	// number of bytes of the current message in the previous input chunks
 	char check_sum, their_sum;
+	boolean skip;	// the message has been rejected by the message filter
 };
 
 #define INIT_SPLITTER(sp)	ZERO_FILL(sp)
+#define SPLITTER_RESYNC		(-1)
+
+// recovery mode: on invalid input the splitter skips bytes until the next "8=FIX"
+struct recovery_data
+{
+	boolean enabled;
+	size_t skipped, total;
+	void (*on_skip)(void* context, size_t num_bytes);
+	void* context;
+};
+
+// node tables: classifiers without a table get compiled on the first use, once per process, and each parser
+// keeps its own cache of the tables it has seen, so the shared ones only get looked up under a lock on a miss
+struct cached_table;
+
+struct table_cache
+{
+	struct cached_table** buckets;
+	size_t num_buckets, size;
+};
+
+const struct fix_node_table* get_node_table(struct table_cache* cache, const struct fix_tag_classifier* classifier);
+void free_table_cache(struct table_cache* cache);
+
+// message type filter: rejected messages get skipped by the splitter without copying
+struct message_filter
+{
+	fix_message_filter accept;
+	void* context;
+	boolean verify_checksum;
+	size_t skipped;
+};
 
 NOINLINE void read_message(struct fix_parser* parser);
+boolean is_message_separator(int c);	// white space skipped between messages in the skip_separators mode
+
+// SIMD kernels -----------------------------------------------------------------------------------
+// the kernels for the instruction sets of the CPU are selected once, on the first call from any thread
+
+// structural index: bitmaps of SOH and '=' positions in a message body, one bit per byte
+struct structural_index
+{
+	size_t capacity;
+	uint64_t *soh, *eq;
+};
+
+// returns pointer to the first "8=FIX" in the given bytes, or to a proper prefix of it at the very end,
+// or end if none found
+const char* find_message_start(const char* s, const char* end);
+
+// structural index
+void build_structural_index(struct structural_index* index, const char* s, size_t n);
+void free_structural_index(struct structural_index* index);
 
 // FIX parser -------------------------------------------------------------------------------------
 struct fix_parser
 {
 	const char *ptr, *end, *error;
+	boolean in_place;	// the current input chunk may be modified
 	classifier_func get_classifier;
+	struct table_cache tables;
 	struct string_buffer buffer;
+	char* body;			// message body to parse, either in the buffer or in the input chunk
+	size_t body_size;
+	struct structural_index index;
 	struct real_fix_message message;
+	struct message_batch batch;
 	struct splitter_data splitter;
+	struct recovery_data recovery;
+	struct message_filter filter;
+	fix_tag_callback tag_callback;	// tag streaming mode if not NULL
+	void* tag_context;
+	boolean raw_messages;
+	boolean skip_separators;	// white space between messages is allowed, as in log files
+	boolean lazy_groups;		// groups of the root node get built on the first access
 };
 
 void set_parser_error(struct fix_parser* parser, const char* text, size_t n);
 NOINLINE void parse_message(struct fix_parser* parser);
 
+// lazy groups mode: a group of the root node is only scanned for its end at parse time, and its record
+// in node->tags has no nodes until materialize_lazy_group() builds them from the bytes [begin, end)
+struct lazy_group
+{
+	struct lazy_group* next;
+	size_t index;			// record index of the group tag in node->tags
+	const struct fix_node_table* table;
+	char* begin;
+	const char* end;
+	size_t node_count, recursion_level;
+	struct arena* arena;	// message arena
+};
+
+// builds the nodes of the group with the given record index if the group is still pending;
+// the group is left without nodes if its bytes turn out to be invalid
+void materialize_lazy_group(struct fix_group_node* pnode, size_t index);
+
 // tag reader -------------------------------------------------------------------------------------
 struct tag_reader
 {
-	char* ptr;
+	char *base, *ptr;
 	const char* end;
+	const uint64_t *soh, *eq;	// structural index
 	struct fix_tag current;
 	boolean has_unread_tag;
+	boolean skip_mode;	// validate only, leaving the bytes intact
 	size_t recursion_level;
 	struct fix_parser* parser;
 };
@@ -134,3 +289,8 @@ NOINLINE tag_reader_status read_binary_tag(struct tag_reader* reader, size_t tag
 NOINLINE void report_message_error(struct fix_parser* parser, const char* fmt, ...);
 const char* read_fix_uint(const char* s, const char* const end, size_t* result_ptr);
 
+// decimal digits: count_digits() returns the number of leading digits in the n bytes, and parse_digits()
+// converts n <= 19 digits
+size_t count_digits(const char* s, size_t n);
+uint64_t parse_digits(const char* s, size_t n);
+
@@ -0,0 +1,354 @@
+/*
+Copyright (c) 2013, 2014, 2015, Maxim Konakov
+ All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list
+   of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, this list
+   of conditions and the following disclaimer in the documentation and/or other materials
+   provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY
+AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "fix_parser_impl.h"
+
+#include <ctype.h>
+#include <malloc.h>
+#include <memory.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define STRICT
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+// FIX log file replay ----------------------------------------------------------------------------
+// region of the log file processed by one thread
+struct log_region
+{
+	const char *begin, *end;
+	classifier_func cf;
+	fix_message_handler handler;
+	void* context;
+	const char* error;
+	char error_text[200];	// copy of the parser error
+};
+
+// error message returned by parse_fix_log_file()
+static THREAD_LOCAL char last_error[200];
+
+static
+const char* copy_error(char* dst, size_t size, const char* error)
+{
+	const size_t n = strlen(error);
+
+	if(n < size)
+		memcpy(dst, error, n + 1);
+	else
+	{
+		memcpy(dst, error, size - 1);
+		dst[size - 1] = 0;
+	}
+
+	return dst;
+}
+
+// returns pointer past the trailer of the message starting at s if it is well-formed: "8=FIX...<SOH>9=<length><SOH>",
+// with "10=ddd<SOH>" right after the <length> bytes of the body; NULL otherwise
+static
+const char* skip_message(const char* s, const char* const end)
+{
+	const char* const limit = (end - s > 20) ? s + 20 : end;
+	size_t n;
+	uint64_t length;
+
+	if(end - s < 5 || memcmp(s, "8=FIX", 5) != 0)
+		return NULL;
+
+	for(s += 5; s < limit && *s != SOH; ++s);
+
+	if(limit - s < 3 || s[1] != '9' || s[2] != '=')
+		return NULL;
+
+	// body length
+	s += 3;
+	n = count_digits(s, (end - s > 10) ? 10 : (size_t)(end - s));
+
+	if(n == 0 || n > 9 || s + n == end || s[n] != SOH)
+		return NULL;
+
+	length = parse_digits(s, n);
+	s += n + 1;
+
+	// trailer
+	if((uint64_t)(end - s) < length + 7)
+		return NULL;
+
+	s += length;
+
+	return (s[0] == '1' && s[1] == '0' && s[2] == '=' && isdigit(CHAR_TO_INT(s[3])) && isdigit(CHAR_TO_INT(s[4]))
+			&& isdigit(CHAR_TO_INT(s[5])) && s[6] == SOH) ? s + 7 : NULL;
+}
+
+#define MESSAGE_CHAIN_LENGTH 16	// messages to follow from a region start candidate
+
+// checks if the message starting at s is a real one rather than "8=FIX" inside a data field (tags 96, 213, 355, etc.):
+// it must follow the previous message or the separators between messages, and start a chain of well-formed messages
+// separated by nothing but the separators, which either reaches the end of the file or is MESSAGE_CHAIN_LENGTH
+// messages long. A message embedded into a data field is followed by the rest of the field or the next tag instead.
+static
+boolean is_message_start(const char* const begin, const char* s, const char* const end)
+{
+	size_t i;
+
+	if(s != begin && s[-1] != SOH && !is_message_separator(CHAR_TO_INT(s[-1])))
+		return NO;
+
+	for(i = 0; i < MESSAGE_CHAIN_LENGTH; ++i)
+	{
+		if(!(s = skip_message(s, end)))
+			return NO;
+
+		while(s < end && is_message_separator(CHAR_TO_INT(*s)))
+			++s;
+
+		if(s == end)
+			break;
+	}
+
+	return YES;
+}
+
+// returns pointer to the first valid message start at or after s
+static
+const char* find_region_start(const char* const begin, const char* s, const char* const end)
+{
+	for(s = find_message_start(s, end); s < end && !is_message_start(begin, s, end); s = find_message_start(s + 1, end));
+
+	return s;
+}
+
+static
+void parse_region(struct log_region* region)
+{
+	const struct fix_message* msg;
+	struct fix_parser* const parser = create_fix_parser(region->cf);
+
+	parser->skip_separators = YES;	// log files often have one message per line
+
+	for(msg = get_first_fix_message(parser, region->begin, (size_t)(region->end - region->begin)); msg; msg = get_next_fix_message(parser))
+		region->handler(region->context, msg);
+
+	if(get_fix_parser_error(parser))
+		region->error = copy_error(region->error_text, sizeof(region->error_text), get_fix_parser_error(parser));
+	else if(parser->splitter.state != 0)
+		region->error = "Incomplete FIX message at the end of the log file";
+
+	free_fix_parser(parser);
+}
+
+#ifdef _WIN32
+
+static
+DWORD WINAPI region_thread(LPVOID arg)
+{
+	parse_region((struct log_region*)arg);
+	return 0;
+}
+
+#else
+
+static
+void* region_thread(void* arg)
+{
+	parse_region((struct log_region*)arg);
+	return NULL;
+}
+
+#endif
+
+static
+const char* parse_regions(const char* begin, size_t n, classifier_func cf, size_t num_threads, fix_message_handler handler, void* const* contexts)
+{
+	size_t i;
+	const char* error = NULL;
+	const char* const end = begin + n;
+	struct log_region* const regions = ALLOC_NZ(num_threads, struct log_region);
+
+#ifdef _WIN32
+	HANDLE* const threads = ALLOC_NZ(num_threads, HANDLE);
+#else
+	pthread_t* const threads = ALLOC_NZ(num_threads, pthread_t);
+	boolean* const started = ALLOC_NZ(num_threads, boolean);
+#endif
+
+	// split the file
+	for(i = 0; i < num_threads; ++i)
+	{
+		struct log_region* const r = &regions[i];
+
+		if(i > 0)
+		{
+			const char* from = begin + i * (n / num_threads);
+
+			if(from < regions[i - 1].begin)
+				from = regions[i - 1].begin;
+
+			r->begin = find_region_start(begin, from, end);
+			regions[i - 1].end = r->begin;
+		}
+		else
+			r->begin = begin;
+
+		r->cf = cf;
+		r->handler = handler;
+		r->context = contexts ? contexts[i] : NULL;
+	}
+
+	regions[num_threads - 1].end = end;
+
+	// run threads, the first region gets processed on the calling thread
+	for(i = 1; i < num_threads; ++i)
+	{
+#ifdef _WIN32
+		threads[i] = CreateThread(NULL, 0, region_thread, &regions[i], 0, NULL);
+
+		if(!threads[i])
+			regions[i].error = "Cannot create thread";
+#else
+		if(pthread_create(&threads[i], NULL, region_thread, &regions[i]) == 0)
+			started[i] = YES;
+		else
+			regions[i].error = "Cannot create thread";
+#endif
+	}
+
+	parse_region(&regions[0]);
+
+	for(i = 1; i < num_threads; ++i)
+	{
+#ifdef _WIN32
+		if(threads[i])
+		{
+			WaitForSingleObject(threads[i], INFINITE);
+			CloseHandle(threads[i]);
+		}
+#else
+		if(started[i])
+			pthread_join(threads[i], NULL);
+#endif
+	}
+
+	// report the first error in file order
+	for(i = 0; i < num_threads && !error; ++i)
+		if(regions[i].error)
+			error = copy_error(last_error, sizeof(last_error), regions[i].error);
+
+#ifndef _WIN32
+	FREE(started);
+#endif
+	FREE(threads);
+	FREE(regions);
+	return error;
+}
+
+const char* parse_fix_log_file(const char* file_name, classifier_func cf, size_t num_threads, fix_message_handler handler, void* const* contexts)
+{
+	const char* error;
+
+	if(!file_name || !cf || !handler || num_threads == 0)
+		return "Invalid argument";
+
+#ifdef _WIN32
+	{
+		HANDLE file, mapping;
+		LARGE_INTEGER size;
+		const char* p;
+
+		file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+		if(file == INVALID_HANDLE_VALUE)
+			return "Cannot open file";
+
+		if(!GetFileSizeEx(file, &size) || (uint64_t)size.QuadPart > (size_t)-1)
+		{
+			CloseHandle(file);
+			return "Cannot get file size";
+		}
+
+		if(size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return NULL;
+		}
+
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		p = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+
+		error = p ? parse_regions(p, (size_t)size.QuadPart, cf, num_threads, handler, contexts) : "Cannot map file";
+
+		if(p)
+			UnmapViewOfFile(p);
+
+		if(mapping)
+			CloseHandle(mapping);
+
+		CloseHandle(file);
+	}
+#else
+	{
+		struct stat st;
+		void* p;
+		const int fd = open(file_name, O_RDONLY);
+
+		if(fd < 0)
+			return "Cannot open file";
+
+		if(fstat(fd, &st) != 0)
+		{
+			close(fd);
+			return "Cannot get file size";
+		}
+
+		if(st.st_size == 0)
+		{
+			close(fd);
+			return NULL;
+		}
+
+		p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if(p == MAP_FAILED)
+			error = "Cannot map file";
+		else
+		{
+			madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+			error = parse_regions((const char*)p, (size_t)st.st_size, cf, num_threads, handler, contexts);
+			munmap(p, (size_t)st.st_size);
+		}
+
+		close(fd);
+	}
+#endif
+
+	return error;
+}
@@ -30,62 +30,122 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 // FIX message node -------------------------------------------------------------------------------
 static const size_t caps[] = { 0u, 23u, 47u, 101u, 199u, 401u, 809u };
 
-struct fix_group_node* alloc_group_node()
+// number of valid tags in the table below the given one
+static
+size_t get_tag_rank(const struct fix_node_table* table, size_t tag)
 {
-	return ALLOC_Z(struct fix_group_node);
-}
+	static const unsigned char nibble_bits[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	const unsigned b = table->valid[tag >> 3] & ((1u << (tag & 7)) - 1);
 
-static void free_group_node(struct fix_group_node* pnode);
+	return table->ranks[tag >> 3] + nibble_bits[b & 15] + nibble_bits[b >> 4];
+}
 
 static
-void clear_groups(struct fix_group_node* pnode)
+size_t get_num_slots(const struct fix_node_table* table)
+{
+	return table->ranks[(table->max_tag + 7) / 8];
+}
+
+struct fix_group_node* alloc_group_nodes(struct arena* arena, const struct fix_node_table* table, size_t n, const struct fix_group_node* origin)
 {
 	size_t i;
+	struct fix_group_node* nodes;
+	const size_t num_slots = table->ranks ? get_num_slots(table) : 0;
+	struct tag_slot* slots = NULL;
 
-	for(i = 0; i < caps[pnode->cap_index]; ++i)
+	if(n > (size_t)-1 / sizeof(struct fix_group_node)
+	   || (num_slots > 0 && n > (size_t)-1 / sizeof(struct tag_slot) / num_slots))
+		return NULL;
+
+	nodes = (struct fix_group_node*)arena_alloc(arena, n * sizeof(struct fix_group_node));
+
+	if(!nodes)
+		return NULL;
+
+	// slots are zero-filled by the arena, i.e. free
+	if(num_slots > 0)
 	{
-		struct fix_group_node* p = pnode->buff[i].group;
+		slots = (struct tag_slot*)arena_alloc(arena, n * num_slots * sizeof(struct tag_slot));
 
-		while(p)
-		{
-			struct fix_group_node* const next = p->next;
+		if(!slots)
+			return NULL;
+	}
 
-			free_group_node(p);
-			p = next;
+	for(i = 0; i < n; ++i)
+	{
+		struct fix_group_node* const pnode = &nodes[i];
+
+		pnode->generation = 1;
+		pnode->base = origin->base;
+		pnode->next = (i + 1 < n) ? &nodes[i + 1] : NULL;
+
+		if(slots)
+		{
+			pnode->table = table;
+			pnode->num_slots = num_slots;
+			pnode->slots = slots + i * num_slots;
 		}
 	}
+
+	return nodes;
 }
 
-void clear_group_node(struct fix_group_node* pnode)
+// the slots of the root node get reused across messages, growing to the largest table seen
+void init_root_node(struct fix_group_node* pnode, const struct fix_node_table* table, const char* base)
 {
-	if(pnode && pnode->buff)
+	pnode->base = base;
+
+	if(table->ranks)
 	{
-		clear_groups(pnode);
-		FREE(pnode->buff);
+		const size_t n = get_num_slots(table);
+
+		if(n > pnode->num_slots)
+		{
+			FREE(pnode->slots);
+			pnode->slots = ALLOC_NZ(n, struct tag_slot);
+			pnode->num_slots = n;
+		}
+
+		pnode->table = table;
 	}
+	else
+		pnode->table = NULL;
 }
 
-static
-void free_group_node(struct fix_group_node* pnode)
+void clear_group_node(struct fix_group_node* pnode)
 {
-	clear_group_node(pnode);
-	FREE(pnode);
+	if(pnode)
+	{
+		FREE(pnode->buff);
+		FREE(pnode->slots);
+		FREE(pnode->tags);
+	}
 }
 
 void set_group_node_empty(struct fix_group_node* pnode)
 {
-	if(pnode->buff && pnode->size > 0)
+	// zero-filled slots belong to generation 0, so the table only needs clearing on wrap-around
+	if(++pnode->generation == 0)
 	{
-		clear_groups(pnode);
-		memset(pnode->buff, 0, sizeof(struct fix_tag) * caps[pnode->cap_index]);
-		pnode->size = 0;
+		if(pnode->buff)
+			memset(pnode->buff, 0, sizeof(struct tag_slot) * caps[pnode->cap_index]);
+
+		if(pnode->slots)
+			memset(pnode->slots, 0, sizeof(struct tag_slot) * pnode->num_slots);
+
+		pnode->generation = 1;
 	}
+
+	pnode->size = pnode->hash_size = 0;
+	pnode->lazy = NULL;
 }
 
+#define IS_FREE(p)	((p)->generation != pnode->generation)
+
 static
-struct fix_tag* find_fix_tag(const struct fix_group_node* pnode, size_t tag)
+struct tag_slot* find_hashed_tag(const struct fix_group_node* pnode, size_t tag)
 {
-	struct fix_tag* p;
+	struct tag_slot* p;
 	size_t h1 = tag;
 	const size_t tbl_size = caps[pnode->cap_index];
 
@@ -95,7 +155,7 @@ struct fix_tag* find_fix_tag(const struct fix_group_node* pnode, size_t tag)
 	p = &pnode->buff[h1 % tbl_size];
 
 	// find the tag or an empty slot
-	if(p->tag > 0 && p->tag != tag)
+	if(!IS_FREE(p) && p->tag != tag)
 	{
 		const size_t h2 = 1 + (tag % (tbl_size - 1));
 
@@ -103,58 +163,140 @@ struct fix_tag* find_fix_tag(const struct fix_group_node* pnode, size_t tag)
 		{
 			h1 += h2;
 			p = &pnode->buff[h1 % tbl_size];
-		} while(p->tag > 0 && p->tag != tag);
+		} while(!IS_FREE(p) && p->tag != tag);
 	}
 
 	return p;
 }
 
 static
-boolean expand_message_node(struct fix_group_node* pnode)
+struct tag_slot* alloc_slots(size_t n, struct arena* arena)
+{
+	return arena ? (struct tag_slot*)arena_alloc(arena, n * sizeof(struct tag_slot)) : ALLOC_NZ(n, struct tag_slot);
+}
+
+static
+boolean expand_message_node(struct fix_group_node* pnode, struct arena* arena)
 {
 	if(pnode->cap_index > 0)
 	{
 		size_t i;
-		struct fix_tag* old_buff;
+		struct tag_slot* old_buff;
 
 		if(pnode->cap_index == sizeof(caps)/sizeof(caps[0]) - 1)
 			return NO;	// too many tags
 
 		old_buff = pnode->buff;
-		pnode->buff = ALLOC_NZ(caps[++pnode->cap_index], struct fix_tag);
+		pnode->buff = alloc_slots(caps[pnode->cap_index + 1], arena);
+
+		if(!pnode->buff)
+		{
+			pnode->buff = old_buff;
+			return NO;
+		}
+
+		++pnode->cap_index;
 
-		for(i = 0; i < caps[pnode->cap_index]; ++i)
+		for(i = 0; i < caps[pnode->cap_index - 1]; ++i)
 		{
-			struct fix_tag* const p = &old_buff[i];
+			struct tag_slot* const p = &old_buff[i];
 
-			if(p->tag > 0)
-				*find_fix_tag(pnode, p->tag) = *p;
+			if(!IS_FREE(p))
+			{
+				*find_hashed_tag(pnode, p->tag) = *p;
+			}
 		}
 
-		FREE(old_buff);
+		if(!arena)
+			FREE(old_buff);
+	}
+	else
+	{
+		pnode->buff = alloc_slots(caps[pnode->cap_index + 1], arena);
+
+		if(!pnode->buff)
+			return NO;
+
+		++pnode->cap_index;
+	}
+
+	return YES;
+}
+
+// grows the array of tag records of the node, either on the heap (root node) or in the arena;
+// returns NO if out of memory, leaving the node unchanged
+static
+boolean grow_node_tags(struct fix_group_node* pnode, struct arena* arena)
+{
+	const size_t n = pnode->tags_capacity > 0 ? 2 * pnode->tags_capacity : 8;
+	struct fix_tag* p;
+
+	if(arena)
+	{
+		p = (struct fix_tag*)arena_alloc(arena, n * sizeof(struct fix_tag));
+
+		if(p && pnode->tags)
+			memcpy(p, pnode->tags, pnode->tags_capacity * sizeof(struct fix_tag));
 	}
 	else
-		pnode->buff = ALLOC_NZ(caps[++pnode->cap_index], struct fix_tag);
+		p = REALLOC(struct fix_tag, pnode->tags, n);
 
+	if(!p)
+		return NO;
+
+	pnode->tags = p;
+	pnode->tags_capacity = n;
 	return YES;
 }
 
-struct fix_tag* add_fix_tag(struct fix_group_node* pnode, const struct fix_tag* new_tag)
+const struct tag_slot* add_fix_tag(struct fix_group_node* pnode, const struct fix_tag* new_tag, struct arena* arena)
 {
-	struct fix_tag* ptag;
+	struct tag_slot* p;
 
-	if(pnode->size >= (3 * caps[pnode->cap_index]) / 4 && !expand_message_node(pnode))
-		return NULL;	// too many tags
+	// the compact slot needs the tag and the value offset to fit in 32 bits, which MAX_MESSAGE_LEN ensures
+	// for the offset
+	if(new_tag->tag != (uint32_t)new_tag->tag || pnode->size > 0xFFFF)
+		return NULL;
 
-	ptag = find_fix_tag(pnode, new_tag->tag);
+	if(pnode->table && new_tag->tag < pnode->table->max_tag)
+		p = &pnode->slots[get_tag_rank(pnode->table, new_tag->tag)];	// the parser only adds valid tags
+	else
+	{
+		if(pnode->hash_size >= (3 * caps[pnode->cap_index]) / 4 && !expand_message_node(pnode, arena))
+			return NULL;	// too many tags
+
+		p = find_hashed_tag(pnode, new_tag->tag);
+
+		if(IS_FREE(p))
+			++pnode->hash_size;
+	}
+
+	if(!IS_FREE(p))	// duplicate
+		return p;
+
+	if(pnode->size == pnode->tags_capacity && !grow_node_tags(pnode, arena))
+		return NULL;	// out of memory
 
-	if(ptag->tag == new_tag->tag)	// duplicate
-		return ptag;
+	p->tag = (uint32_t)new_tag->tag;
+	p->length = (uint32_t)new_tag->length;
+	p->offset = new_tag->value ? (uint32_t)(new_tag->value - pnode->base) : GROUP_OFFSET;	// group tags have no value
+	p->generation = pnode->generation;
+	p->index = (uint16_t)pnode->size;
+	pnode->tags[pnode->size++] = *new_tag;
+	return p;
+}
+
+static
+const struct tag_slot* find_fix_tag(const struct fix_group_node* pnode, size_t tag)
+{
+	const struct tag_slot* p;
 
-	*ptag = *new_tag;
-	++pnode->size;
+	if(pnode->table && tag < pnode->table->max_tag)
+		p = TEST_BIT(pnode->table->valid, tag) ? &pnode->slots[get_tag_rank(pnode->table, tag)] : NULL;
+	else
+		p = find_hashed_tag(pnode, tag);
 
-	return ptag;
+	return (p && !IS_FREE(p)) ? p : NULL;
 }
 
 // FIX node interface -----------------------------------------------------------------------------
@@ -163,11 +305,46 @@ const struct fix_group_node* get_next_fix_node(const struct fix_group_node* pnod
 	return pnode->next;
 }
 
+// in the lazy groups mode a group gets built on the first access to its record
+static
+const struct fix_tag* get_tag_record(const struct fix_group_node* node, size_t i)
+{
+	if(node->lazy && !node->tags[i].value)
+		materialize_lazy_group((struct fix_group_node*)node, i);
+
+	return &node->tags[i];
+}
+
 const struct fix_tag* get_fix_tag(const struct fix_group_node* node, size_t tag)
 {
-	const struct fix_tag* const p = find_fix_tag(node, tag);
+	const struct tag_slot* const p = find_fix_tag(node, tag);
 
-	return p && p->tag == tag ? p : NULL;
+	return p ? get_tag_record(node, p->index) : NULL;
+}
+
+const struct fix_tag* get_fix_node_tag(const struct fix_group_node* node, size_t i)
+{
+	return (i < node->size) ? get_tag_record(node, i) : NULL;
+}
+
+const char* get_fix_tag_value(const struct fix_group_node* node, size_t tag, size_t* p_length)
+{
+	const struct tag_slot* const p = find_fix_tag(node, tag);
+
+	if(!p || (p->offset & GROUP_OFFSET))
+		return NULL;
+
+	if(p_length)
+		*p_length = p->length;
+
+	return node->base + p->offset;
+}
+
+const struct fix_group_node* get_fix_group(const struct fix_group_node* node, size_t tag)
+{
+	const struct tag_slot* const p = find_fix_tag(node, tag);
+
+	return (p && (p->offset & GROUP_OFFSET)) ? get_tag_record(node, p->index)->group : NULL;
 }
 
 size_t get_fix_node_size(const struct fix_group_node* node)
@@ -175,3 +352,13 @@ size_t get_fix_node_size(const struct fix_group_node* node)
 	return node->size;
 }
 
+size_t get_fix_group_size(const struct fix_group_node* group)
+{
+	return group->group_size;
+}
+
+const struct fix_group_node* get_fix_group_entry(const struct fix_group_node* group, size_t i)
+{
+	return (i < group->group_size) ? group + i : NULL;
+}
+
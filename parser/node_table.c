@@ -0,0 +1,335 @@
+/*
+Copyright (c) 2013, 2014, 2015, Maxim Konakov
+ All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list
+   of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, this list
+   of conditions and the following disclaimer in the documentation and/or other materials
+   provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY
+AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "fix_parser_impl.h"
+
+#include <malloc.h>
+#include <memory.h>
+
+#ifdef _WIN32
+#define STRICT
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// classifier compiled into a node table; the tables are shared by all parsers and live as long as the process
+struct compiled_table
+{
+	struct fix_node_table table;
+	struct fix_tag_classifier classifier;	// copy of the classifier, so a new classifier at the same address is not mistaken for the old one
+	struct compiled_table* next;
+};
+
+// per parser cache entry
+struct cached_table
+{
+	const struct fix_tag_classifier* classifier;
+	struct fix_tag_classifier copy;	// compared on every hit, as the classifier at the address may have been replaced
+	const struct fix_node_table* table;
+	struct cached_table* next;	// next in the hash bucket
+};
+
+// compiled tables --------------------------------------------------------------------------------
+static struct compiled_table* compiled_tables;
+
+#ifdef _WIN32
+static SRWLOCK tables_lock = SRWLOCK_INIT;
+
+#define LOCK_TABLES()	AcquireSRWLockExclusive(&tables_lock)
+#define UNLOCK_TABLES()	ReleaseSRWLockExclusive(&tables_lock)
+#else
+static pthread_mutex_t tables_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#define LOCK_TABLES()	pthread_mutex_lock(&tables_lock)
+#define UNLOCK_TABLES()	pthread_mutex_unlock(&tables_lock)
+#endif
+
+static
+boolean same_classifier(const struct fix_tag_classifier* a, const struct fix_tag_classifier* b)
+{
+	return (a->is_valid_tag == b->is_valid_tag
+			&& a->get_data_tag == b->get_data_tag
+			&& a->is_first_in_group == b->is_first_in_group
+			&& a->get_group_classifier == b->get_group_classifier
+			&& a->is_interesting_tag == b->is_interesting_tag) ? YES : NO;
+}
+
+// table cache ------------------------------------------------------------------------------------
+static
+size_t hash_pointer(const void* p, size_t num_buckets)
+{
+	const size_t h = (size_t)p;
+
+	return (h ^ (h >> 7) ^ (h >> 17)) & (num_buckets - 1);
+}
+
+static
+void grow_table_cache(struct table_cache* cache)
+{
+	size_t i;
+	const size_t n = cache->num_buckets > 0 ? 2 * cache->num_buckets : 32;
+	struct cached_table** const buckets = ALLOC_NZ(n, struct cached_table*);
+
+	for(i = 0; i < cache->num_buckets; ++i)
+	{
+		struct cached_table* p = cache->buckets[i];
+
+		while(p)
+		{
+			struct cached_table* const next = p->next;
+			const size_t k = hash_pointer(p->classifier, n);
+
+			p->next = buckets[k];
+			buckets[k] = p;
+			p = next;
+		}
+	}
+
+	FREE(cache->buckets);
+	cache->buckets = buckets;
+	cache->num_buckets = n;
+}
+
+static
+struct cached_table* find_cached_table(const struct table_cache* cache, const struct fix_tag_classifier* classifier)
+{
+	struct cached_table* p;
+
+	if(cache->num_buckets == 0)
+		return NULL;
+
+	for(p = cache->buckets[hash_pointer(classifier, cache->num_buckets)]; p && p->classifier != classifier; p = p->next);
+
+	return p;
+}
+
+static
+void insert_cached_table(struct table_cache* cache, const struct fix_tag_classifier* classifier, const struct fix_node_table* table)
+{
+	size_t k;
+	struct cached_table* const pt = ALLOC_NZ(1, struct cached_table);
+
+	if(cache->size >= cache->num_buckets)
+		grow_table_cache(cache);
+
+	pt->classifier = classifier;
+	pt->copy = *classifier;
+	pt->table = table;
+	k = hash_pointer(classifier, cache->num_buckets);
+	pt->next = cache->buckets[k];
+	cache->buckets[k] = pt;
+	++cache->size;
+}
+
+void free_table_cache(struct table_cache* cache)
+{
+	size_t i;
+
+	for(i = 0; i < cache->num_buckets; ++i)
+	{
+		struct cached_table* p = cache->buckets[i];
+
+		while(p)
+		{
+			struct cached_table* const next = p->next;
+
+			FREE(p);
+			p = next;
+		}
+	}
+
+	FREE(cache->buckets);
+	cache->buckets = NULL;
+	cache->num_buckets = cache->size = 0;
+}
+
+// classifier compiler ----------------------------------------------------------------------------
+#define SET_BIT(bits, tag)	((bits)[(tag) >> 3] |= (unsigned char)(1u << ((tag) & 7)))
+
+// per byte counts of the valid tags, for the slot storage in the message nodes
+static
+const unsigned short* compute_ranks(const unsigned char* valid, size_t max_tag)
+{
+	size_t i, n = 0;
+	const size_t num_bytes = (max_tag + 7) / 8;
+	unsigned short* const ranks = ALLOC_NZ(num_bytes + 1, unsigned short);
+
+	for(i = 0; i < num_bytes; ++i)
+	{
+		unsigned b;
+
+		ranks[i] = (unsigned short)n;
+
+		for(b = valid[i]; b != 0; b &= b - 1)
+			++n;
+	}
+
+	ranks[num_bytes] = (unsigned short)n;
+	return ranks;
+}
+
+static
+const struct fix_node_table* compile_table(const struct fix_tag_classifier* classifier);
+
+// probes the classifier functions for every tag from 1 to MAX_COMPILED_TAG
+static
+void compile_classifier(struct compiled_table* pt)
+{
+	size_t tag, max_tag = 0, num_data_tags = 0, num_groups = 0;
+	unsigned char *valid, *special, *interesting = NULL;
+	struct fix_data_tag_entry* data_tags;
+	struct fix_group_entry* groups;
+	const struct fix_tag_classifier* const cl = &pt->classifier;
+
+	// table size
+	for(tag = 1; tag <= MAX_COMPILED_TAG; ++tag)
+	{
+		if(cl->get_data_tag(tag) != 0)
+		{
+			max_tag = tag;
+			++num_data_tags;
+		}
+		else if(cl->is_valid_tag(tag))
+		{
+			max_tag = tag;
+
+			if(cl->get_group_classifier(tag))
+				++num_groups;
+		}
+	}
+
+	++max_tag;
+
+	valid = ALLOC_NZ((max_tag + 7) / 8, unsigned char);
+	special = ALLOC_NZ((max_tag + 7) / 8, unsigned char);
+
+	if(cl->is_interesting_tag)
+		interesting = ALLOC_NZ((max_tag + 7) / 8, unsigned char);
+
+	data_tags = ALLOC_NZ(num_data_tags + 1, struct fix_data_tag_entry);
+	groups = ALLOC_NZ(num_groups + 1, struct fix_group_entry);
+
+	pt->table.max_tag = max_tag;
+	pt->table.valid = valid;
+	pt->table.special = special;
+	pt->table.interesting = interesting;
+	pt->table.data_tags = data_tags;
+	pt->table.groups = groups;
+	pt->table.fallback = cl;
+
+	// fill in, in ascending tag order
+	for(tag = 1; tag < max_tag; ++tag)
+	{
+		const size_t data_tag = cl->get_data_tag(tag);
+
+		if(data_tag != 0)
+		{
+			SET_BIT(special, tag);
+			data_tags->length_tag = tag;
+			data_tags->data_tag = data_tag;
+			++data_tags;
+			++pt->table.num_data_tags;
+		}
+
+		if(cl->is_valid_tag(tag))
+		{
+			SET_BIT(valid, tag);
+
+			if(interesting && cl->is_interesting_tag(tag))
+				SET_BIT(interesting, tag);
+
+			if(pt->table.first_tag == 0 && cl->is_first_in_group(tag))
+				pt->table.first_tag = tag;
+
+			if(data_tag == 0)
+			{
+				const struct fix_tag_classifier* const group_cl = cl->get_group_classifier(tag);
+
+				if(group_cl)
+				{
+					SET_BIT(special, tag);
+					groups->length_tag = tag;
+					groups->node = compile_table(group_cl);
+					++groups;
+					++pt->table.num_groups;
+				}
+			}
+		}
+	}
+
+	pt->table.ranks = compute_ranks(valid, max_tag);
+}
+
+// returns the compiled table for the classifier, compiling it if needed; called with the tables locked
+static
+const struct fix_node_table* compile_table(const struct fix_tag_classifier* classifier)
+{
+	struct compiled_table* pt;
+
+	if(classifier->table)
+		return classifier->table;
+
+	for(pt = compiled_tables; pt && !same_classifier(&pt->classifier, classifier); pt = pt->next);
+
+	if(!pt)
+	{
+		// inserting before compiling, in case the group classifiers refer back to this one
+		pt = ALLOC_Z(struct compiled_table);
+		pt->classifier = *classifier;
+		pt->next = compiled_tables;
+		compiled_tables = pt;
+		compile_classifier(pt);
+	}
+
+	return &pt->table;
+}
+
+const struct fix_node_table* get_node_table(struct table_cache* cache, const struct fix_tag_classifier* classifier)
+{
+	struct cached_table* pc;
+	const struct fix_node_table* table;
+
+	if(classifier->table)
+		return classifier->table;
+
+	pc = find_cached_table(cache, classifier);
+
+	if(pc && same_classifier(&pc->copy, classifier))
+		return pc->table;
+
+	LOCK_TABLES();
+	table = compile_table(classifier);
+	UNLOCK_TABLES();
+
+	if(pc)
+	{	// a different classifier at the same address
+		pc->copy = *classifier;
+		pc->table = table;
+	}
+	else
+		insert_cached_table(cache, classifier, table);
+
+	return table;
+}
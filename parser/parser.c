@@ -87,9 +87,94 @@ const struct fix_message* run_parser(struct fix_parser* parser)
 struct parser_state
 {
 	struct fix_group_node* node;
-	const struct fix_tag_classifier* classifier;
+	const struct fix_node_table* table;
+	struct arena* arena;		// arena of the current node, NULL for the root node (heap)
+	struct arena* group_arena;	// arena for new group nodes
+	fix_tag_callback callback;	// tag streaming mode if not NULL
+	void* context;
 };
 
+// node table lookups
+static
+boolean is_valid_tag(const struct fix_node_table* table, size_t tag)
+{
+	if(tag < table->max_tag)
+		return TEST_BIT(table->valid, tag) ? YES : NO;
+
+	return (table->fallback && table->fallback->is_valid_tag(tag)) ? YES : NO;
+}
+
+static
+boolean is_first_in_group(const struct fix_node_table* table, size_t tag)
+{
+	if(tag < table->max_tag)
+		return (tag == table->first_tag && tag != 0) ? YES : NO;
+
+	return (table->fallback && table->fallback->is_first_in_group(tag)) ? YES : NO;
+}
+
+static
+boolean is_interesting_tag(const struct fix_node_table* table, size_t tag)
+{
+	if(tag < table->max_tag)
+		return (!table->interesting || TEST_BIT(table->interesting, tag)) ? YES : NO;
+
+	return (!table->fallback || !table->fallback->is_interesting_tag || table->fallback->is_interesting_tag(tag)) ? YES : NO;
+}
+
+static
+size_t get_data_tag(const struct fix_node_table* table, size_t tag)
+{
+	if(tag < table->max_tag)
+	{
+		if(TEST_BIT(table->special, tag))
+		{
+			size_t lo = 0, hi = table->num_data_tags;
+
+			while(lo < hi)
+			{
+				const size_t mid = (lo + hi) / 2;
+
+				if(table->data_tags[mid].length_tag < tag)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+
+			if(lo < table->num_data_tags && table->data_tags[lo].length_tag == tag)
+				return table->data_tags[lo].data_tag;
+		}
+
+		return 0;
+	}
+
+	return table->fallback ? table->fallback->get_data_tag(tag) : 0;
+}
+
+static
+const struct fix_node_table* get_group_table(const struct fix_node_table* table, size_t tag)
+{
+	if(tag < table->max_tag && TEST_BIT(table->special, tag))
+	{
+		size_t lo = 0, hi = table->num_groups;
+
+		while(lo < hi)
+		{
+			const size_t mid = (lo + hi) / 2;
+
+			if(table->groups[mid].length_tag < tag)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		if(lo < table->num_groups && table->groups[lo].length_tag == tag)
+			return table->groups[lo].node;
+	}
+
+	return NULL;
+}
+
 // ask reader to read the next tag; every binary "Len" tag gets silently replaced with its corresponding data tag
 static
 tag_reader_status get_next_tag(struct tag_reader* reader, struct parser_state* state)
@@ -102,7 +187,7 @@ tag_reader_status get_next_tag(struct tag_reader* reader, struct parser_state* s
 		return TR_ERROR;
 
 	case TR_DONE:
-		t = state->classifier->get_data_tag(reader->current.tag);
+		t = get_data_tag(state->table, reader->current.tag);
 
 		if(t != 0)
 		{
@@ -113,7 +198,7 @@ tag_reader_status get_next_tag(struct tag_reader* reader, struct parser_state* s
 			return TR_DONE;
 
 	case TR_OK:
-		t = state->classifier->get_data_tag(reader->current.tag);
+		t = get_data_tag(state->table, reader->current.tag);
 
 		return (t != 0) ? read_binary_tag(reader, t) : TR_OK;
 
@@ -125,34 +210,52 @@ tag_reader_status get_next_tag(struct tag_reader* reader, struct parser_state* s
 
 // add the current tag to the current node, with error handling
 static
-struct fix_tag* add_current_tag(struct tag_reader* reader, struct fix_group_node* node)
+boolean add_current_tag(struct tag_reader* reader, struct parser_state* state)
 {
-	struct fix_tag* pt = add_fix_tag(node, &reader->current);
+	size_t size;
+
+	if(reader->skip_mode)
+		return YES;
+
+	if(state->callback)	// streaming mode
+		return state->callback(state->context, FIX_TAG, &reader->current) ? YES : NO;
+
+	if(!is_interesting_tag(state->table, reader->current.tag))
+		return YES;
 
-	if(!pt)
+	size = state->node->size;
+
+	if(!add_fix_tag(state->node, &reader->current, state->arena))
 	{
 		report_message_error(reader->parser, "Too many tags in a message node");
-		return NULL;
+		return NO;
 	}
 
-	if(reader->current.value != pt->value)
+	if(state->node->size == size)
 	{
-		report_message_error(reader->parser, "Duplicate tag %u in a message node", (unsigned)pt->tag);
-		return NULL;
+		report_message_error(reader->parser, "Duplicate tag %u in a message node", (unsigned)reader->current.tag);
+		return NO;
 	}
 
-	return pt;
+	return YES;
 }
 
 static
-boolean read_group(struct tag_reader* reader, struct parser_state* state, const struct fix_tag_classifier* classifier);
+boolean read_group(struct tag_reader* reader, struct parser_state* state, const struct fix_node_table* node_table);
+
+// group length tags beyond the table cannot be supported, as the group node table is unknown
+static
+boolean is_unsupported_group_tag(const struct fix_node_table* table, size_t tag)
+{
+	return (tag >= table->max_tag && table->fallback && table->fallback->get_group_classifier(tag)) ? YES : NO;
+}
 
 static
 boolean dispatch_tag(struct tag_reader* reader, struct parser_state* state)
 {
-	const struct fix_tag_classifier* const cl = state->classifier->get_group_classifier(reader->current.tag);
+	const struct fix_node_table* const node_table = get_group_table(state->table, reader->current.tag);
 
-	if(cl)
+	if(node_table)
 	{
 		if(++reader->recursion_level == MAX_GROUP_DEPTH)
 		{
@@ -160,10 +263,16 @@ boolean dispatch_tag(struct tag_reader* reader, struct parser_state* state)
 			return NO;
 		}
 
-		return read_group(reader, state, cl);
+		return read_group(reader, state, node_table);
 	}
-	else
-		return add_current_tag(reader, state->node) ? YES : NO;
+
+	if(is_unsupported_group_tag(state->table, reader->current.tag))
+	{
+		report_message_error(reader->parser, "Unsupported group tag %u", (unsigned)reader->current.tag);
+		return NO;
+	}
+
+	return add_current_tag(reader, state);
 }
 
 static
@@ -183,19 +292,19 @@ boolean read_node(struct tag_reader* reader, struct parser_state* state)
 		return NO;
 	}
 
-	if(!state->classifier->is_first_in_group(reader->current.tag))
+	if(!is_first_in_group(state->table, reader->current.tag))
 	{
 		report_message_error(reader->parser, "Unexpected tag %u", reader->current.tag);
 		return NO;
 	}
 
-	if(!add_current_tag(reader, state->node))
+	if(!add_current_tag(reader, state))
 		return NO;
 
 	// other tags
 	for(r = get_next_tag(reader, state); r == TR_OK; r = get_next_tag(reader, state))
 	{
-		if(!state->classifier->is_valid_tag(reader->current.tag) || state->classifier->is_first_in_group(reader->current.tag))
+		if(!is_valid_tag(state->table, reader->current.tag) || is_first_in_group(state->table, reader->current.tag))
 		{
 			reader->has_unread_tag = YES;
 			return YES;
@@ -208,11 +317,158 @@ boolean read_node(struct tag_reader* reader, struct parser_state* state)
 	return (r != TR_ERROR) ? YES : NO;
 }
 
+// streaming mode group reader
 static
-boolean read_group(struct tag_reader* reader, struct parser_state* state, const struct fix_tag_classifier* classifier)
+boolean stream_group(struct tag_reader* reader, struct parser_state* state, const struct fix_node_table* node_table)
+{
+	size_t i;
+	struct parser_state new_state = *state;
+	const struct fix_tag group_tag = reader->current;
+
+	new_state.table = node_table;
+
+	if(!state->callback(state->context, FIX_GROUP_BEGIN, &group_tag))
+		return NO;
+
+	for(i = 0; i < group_tag.length; ++i)
+	{
+		if(!state->callback(state->context, FIX_GROUP_NODE, &group_tag) || !read_node(reader, &new_state))
+			return NO;
+	}
+
+	return state->callback(state->context, FIX_GROUP_END, &group_tag) ? YES : NO;
+}
+
+// reads the given number of group nodes, into the nodes linked from state->node unless in skip mode
+static
+boolean read_nodes(struct tag_reader* reader, struct parser_state* state, size_t node_count)
+{
+	if(!read_node(reader, state))
+		return NO;
+
+	while(--node_count > 0)
+	{
+		if(!reader->skip_mode)
+			state->node = state->node->next;
+
+		if(!read_node(reader, state))
+			return NO;
+	}
+
+	return YES;
+}
+
+// validates the group nodes without modifying the bytes
+static
+boolean skip_nodes(struct tag_reader* reader, struct parser_state* state, size_t node_count)
+{
+	reader->skip_mode = YES;
+
+	if(!read_nodes(reader, state, node_count))
+		return NO;
+
+	reader->skip_mode = NO;
+
+	if(reader->has_unread_tag)
+		reader->ptr[-1] = 0;	// the tag following the group has been read in skip mode
+
+	return YES;
+}
+
+// lazy groups mode: finds the end of the group by following its tags through the node tables, without
+// building or validating the nodes; the group ends at the first tag valid neither in the group nor in any
+// of the nested groups it is in, as it does when the nodes get read
+static
+boolean scan_group(struct tag_reader* reader, const struct parser_state* state, const struct fix_node_table* node_table, const char** p_end)
+{
+	const struct fix_node_table* tables[MAX_GROUP_DEPTH];
+	size_t depth = 0;
+	struct parser_state scan_state = *state;
+	const char* tag_start = reader->ptr;
+	tag_reader_status r;
+
+	scan_state.table = node_table;
+	reader->skip_mode = YES;
+
+	for(r = get_next_tag(reader, &scan_state); r == TR_OK; tag_start = reader->ptr, r = get_next_tag(reader, &scan_state))
+	{
+		const struct fix_node_table* group_table;
+
+		while(!is_valid_tag(scan_state.table, reader->current.tag))
+		{
+			if(depth == 0)
+			{
+				reader->skip_mode = NO;
+				reader->has_unread_tag = YES;
+				reader->ptr[-1] = 0;	// the tag following the group has been read in skip mode
+				*p_end = tag_start;
+				return YES;
+			}
+
+			scan_state.table = tables[--depth];
+		}
+
+		group_table = get_group_table(scan_state.table, reader->current.tag);
+
+		if(group_table)
+		{
+			if(++reader->recursion_level == MAX_GROUP_DEPTH)
+			{
+				report_message_error(reader->parser, "Maximum level of recursion has been reached");
+				return NO;
+			}
+
+			tables[depth++] = scan_state.table;
+			scan_state.table = group_table;
+		}
+	}
+
+	if(r == TR_ERROR)
+		return NO;
+
+	reader->skip_mode = NO;
+	*p_end = reader->end;
+	return YES;
+}
+
+// records the group tag without nodes, and the group bytes for materialize_lazy_group()
+static
+boolean read_lazy_group(struct tag_reader* reader, struct parser_state* state, const struct fix_node_table* node_table)
+{
+	struct lazy_group* const group = (struct lazy_group*)arena_alloc(state->group_arena, sizeof(struct lazy_group));
+
+	if(!group)
+	{
+		report_message_error(reader->parser, "Out of memory while allocating a lazy group");
+		return NO;
+	}
+
+	group->index = state->node->size;
+	group->table = node_table;
+	group->node_count = reader->current.length;
+	group->recursion_level = reader->recursion_level;
+	group->arena = state->group_arena;
+
+	reader->current.group = NULL;
+
+	if(!add_current_tag(reader, state))
+		return NO;
+
+	group->begin = reader->ptr;
+
+	if(!scan_group(reader, state, node_table, &group->end))
+		return NO;
+
+	group->next = state->node->lazy;
+	state->node->lazy = group;
+	return YES;
+}
+
+static
+boolean read_group(struct tag_reader* reader, struct parser_state* state, const struct fix_node_table* node_table)
 {
 	size_t node_count;
-	struct fix_tag* group_tag;
+	struct parser_state new_state;
 
 	if(!read_fix_uint(reader->current.value, reader->current.value + reader->current.length, &node_count))
 	{
@@ -220,33 +476,62 @@ boolean read_group(struct tag_reader* reader, struct parser_state* state, const
 		return NO;
 	}
 
+	// every node takes at least one "t=v<SOH>" field, so a count the remaining bytes cannot hold
+	// gets rejected before anything is allocated for it
+	if(node_count > (size_t)(reader->end - reader->ptr) / 4)
+	{
+		report_message_error(reader->parser, "Unexpected end of message while reading a group node");
+		return NO;
+	}
+
 	reader->current.value = NULL;
 	reader->current.length = node_count;
-	group_tag = add_current_tag(reader, state->node);
 
-	if(!group_tag)
-		return NO;
+	if(state->callback)
+		return stream_group(reader, state, node_table);
 
-	if(node_count > 0)
+	if(!reader->skip_mode && !is_interesting_tag(state->table, reader->current.tag))
 	{
-		struct parser_state new_state;
+		new_state = *state;
+		new_state.table = node_table;
+		return node_count > 0 ? skip_nodes(reader, &new_state, node_count) : YES;
+	}
 
-		new_state.classifier = classifier;
-		group_tag->group = new_state.node = alloc_group_node();
+	new_state = *state;
+	new_state.table = node_table;
+	new_state.arena = state->group_arena;
 
-		if(!read_node(reader, &new_state))
-			return NO;
+	if(reader->skip_mode)
+		return node_count > 0 ? read_nodes(reader, &new_state, node_count) : YES;
 
-		while(--node_count > 0)
-		{
-			new_state.node = new_state.node->next = alloc_group_node();
+	if(reader->parser->lazy_groups && node_count > 0)
+		return read_lazy_group(reader, state, node_table);
 
-			if(!read_node(reader, &new_state))
-				return NO;
+	// the group nodes go with the group tag, so they get allocated first
+	if(node_count > 0)
+	{
+		new_state.node = alloc_group_nodes(state->group_arena, node_table, node_count, state->node);
+
+		if(!new_state.node)
+		{
+			report_message_error(reader->parser, "Out of memory while allocating %u group nodes", (unsigned)node_count);
+			return NO;
 		}
+
+		new_state.node->group_size = node_count;
 	}
+	else
+		new_state.node = NULL;
 
-	return YES;
+	reader->current.group = new_state.node;
+
+	if(!add_current_tag(reader, state))
+		return NO;
+
+	if(node_count == 0)
+		return YES;
+
+	return read_nodes(reader, &new_state, node_count);
 }
 
 static
@@ -256,7 +541,7 @@ void process_root_node(struct tag_reader* reader, struct parser_state* state)
 
 	for(r = get_next_tag(reader, state); r == TR_OK; r = get_next_tag(reader, state))
 	{
-		if(!state->classifier->is_valid_tag(reader->current.tag))
+		if(!is_valid_tag(state->table, reader->current.tag))
 		{
 			report_message_error(reader->parser, "Unexpected tag %u", (unsigned)reader->current.tag);
 			break;
@@ -272,16 +557,21 @@ void parse_message(struct fix_parser* parser)
 {
 	struct parser_state state;
 	struct tag_reader reader;
+	const struct fix_tag_classifier* const classifier = parser->get_classifier(parser->message.properties.version, parser->message.properties.type);
 
-	state.classifier = parser->get_classifier(parser->message.properties.version, parser->message.properties.type);
-
-	if(!state.classifier)
+	if(!classifier)
 	{
 		report_message_error(parser, "Unrecognised message");
 		return;
 	}
 
+	state.table = get_node_table(&parser->tables, classifier);
 	state.node = &parser->message.root;
+	init_root_node(state.node, state.table, parser->body);
+	state.arena = NULL;
+	state.group_arena = parser->message.arena;
+	state.callback = parser->tag_callback;
+	state.context = parser->tag_context;
 	init_tag_reader(parser, &reader);
 
 	process_root_node(&reader, &state);
@@ -289,6 +579,50 @@ void parse_message(struct fix_parser* parser)
 	parser->message.complete = YES;
 }
 
+// lazy groups mode
+void materialize_lazy_group(struct fix_group_node* pnode, size_t index)
+{
+	struct lazy_group** p;
+	struct lazy_group* group;
+	struct fix_parser parser;	// error reporting and structural index for the group bytes only
+	struct tag_reader reader;
+	struct parser_state state;
+
+	for(p = &pnode->lazy; *p && (*p)->index != index; p = &(*p)->next);
+
+	if(!*p)
+		return;
+
+	// the group gets one attempt, successful or not
+	group = *p;
+	*p = group->next;
+
+	ZERO_FILL(&parser);
+	parser.body = group->begin;
+	parser.body_size = group->end - group->begin;
+	init_tag_reader(&parser, &reader);
+	reader.recursion_level = group->recursion_level;
+
+	state.node = alloc_group_nodes(group->arena, group->table, group->node_count, pnode);
+	state.table = group->table;
+	state.arena = state.group_arena = group->arena;
+	state.callback = NULL;
+	state.context = NULL;
+
+	if(state.node)
+	{
+		struct fix_group_node* const first = state.node;
+
+		first->group_size = group->node_count;
+
+		if(read_nodes(&reader, &state, group->node_count) && !reader.has_unread_tag)
+			pnode->tags[index].group = first;
+	}
+
+	free_structural_index(&parser.index);
+	FREE(parser.buffer.str);
+}
+
 // FIX parser interface ---------------------------------------------------------------------------
 struct fix_parser* create_fix_parser(classifier_func cf)
 {
@@ -297,16 +631,43 @@ struct fix_parser* create_fix_parser(classifier_func cf)
 	assert(cf);
 
 	parser->get_classifier = cf;
+	set_message_empty(&parser->message);
 	INIT_SPLITTER(&parser->splitter);
 	return parser;
 }
 
+static
+void free_message(struct real_fix_message* msg, struct string_buffer* buffer)
+{
+	clear_group_node(&msg->root);	// clear root node
+	free_arena(msg->arena);			// clear group nodes
+	FREE(msg->arena);
+
+	FREE(msg->raw.str);
+
+	FREE(buffer->str);				// clear buffer
+}
+
+static
+void free_message_batch(struct message_batch* batch)
+{
+	size_t i;
+
+	for(i = 0; i < batch->capacity; ++i)
+		free_message(&batch->messages[i].message, &batch->messages[i].buffer);
+
+	FREE(batch->messages);
+	FREE(batch->list);
+}
+
 void free_fix_parser(struct fix_parser* parser)
 {
 	if(parser)
 	{
-		clear_group_node(&parser->message.root);	// clear root node
-		FREE(parser->buffer.str);					// clear buffer
+		free_message(&parser->message, &parser->buffer);
+		free_message_batch(&parser->batch);
+		free_structural_index(&parser->index);		// clear index
+		free_table_cache(&parser->tables);			// clear compiled classifiers
 		FREE(parser);								// free the parser
 	}
 }
@@ -316,7 +677,48 @@ const char* get_fix_parser_error(struct fix_parser* parser)
 	return parser->error;
 }
 
-const struct fix_message* get_first_fix_message(struct fix_parser* parser, const void* bytes, size_t n)
+void enable_fix_parser_recovery(struct fix_parser* parser, void (*on_skip)(void* context, size_t num_bytes), void* context)
+{
+	parser->recovery.enabled = YES;
+	parser->recovery.on_skip = on_skip;
+	parser->recovery.context = context;
+}
+
+size_t get_fix_parser_skipped_bytes(struct fix_parser* parser)
+{
+	return parser->recovery.total + parser->recovery.skipped;
+}
+
+void set_fix_message_filter(struct fix_parser* parser, fix_message_filter filter, void* context, int verify_checksum)
+{
+	parser->filter.accept = filter;
+	parser->filter.context = context;
+	parser->filter.verify_checksum = verify_checksum ? YES : NO;
+}
+
+size_t get_fix_parser_filtered_count(struct fix_parser* parser)
+{
+	return parser->filter.skipped;
+}
+
+void enable_fix_parser_raw_messages(struct fix_parser* parser)
+{
+	parser->raw_messages = YES;
+}
+
+void enable_fix_parser_lazy_groups(struct fix_parser* parser)
+{
+	parser->lazy_groups = YES;
+}
+
+void set_fix_tag_callback(struct fix_parser* parser, fix_tag_callback callback, void* context)
+{
+	parser->tag_callback = callback;
+	parser->tag_context = context;
+}
+
+static
+const struct fix_message* run_parser_on_chunk(struct fix_parser* parser, const void* bytes, size_t n, boolean in_place)
 {
 	if(parser->error)
 		return NULL;	// parser is unusable
@@ -329,10 +731,21 @@ const struct fix_message* get_first_fix_message(struct fix_parser* parser, const
 
 	parser->ptr = (const char*)bytes;
 	parser->end = parser->ptr + n;
+	parser->in_place = in_place;
 
 	return run_parser(parser);
 }
 
+const struct fix_message* get_first_fix_message(struct fix_parser* parser, const void* bytes, size_t n)
+{
+	return run_parser_on_chunk(parser, bytes, n, NO);
+}
+
+const struct fix_message* get_first_fix_message_in_place(struct fix_parser* parser, void* bytes, size_t n)
+{
+	return run_parser_on_chunk(parser, bytes, n, YES);
+}
+
 const struct fix_message* get_next_fix_message(struct fix_parser* parser)
 {
 	if(parser->error)
@@ -340,3 +753,68 @@ const struct fix_message* get_next_fix_message(struct fix_parser* parser)
 
 	return run_parser(parser);
 }
+
+// batch interface --------------------------------------------------------------------------------
+static
+void grow_message_batch(struct message_batch* batch)
+{
+	size_t i;
+	const size_t n = batch->capacity > 0 ? 2 * batch->capacity : 16;
+
+	batch->messages = REALLOC(struct batch_message, batch->messages, n);
+	batch->list = REALLOC(const struct fix_message*, batch->list, n);
+
+	for(i = batch->capacity; i < n; ++i)
+	{
+		ZERO_FILL(&batch->messages[i]);
+		set_message_empty(&batch->messages[i].message);
+	}
+
+	batch->capacity = n;
+}
+
+// every complete message is swapped out of the parser into the next batch slot,
+// and the parser continues with the storage previously held by that slot
+static
+const struct fix_message* const* run_batch(struct fix_parser* parser, const void* bytes, size_t n, boolean in_place, size_t* p_count)
+{
+	size_t i;
+	const struct fix_message* msg;
+	struct message_batch* const batch = &parser->batch;
+
+	batch->size = 0;
+
+	for(msg = run_parser_on_chunk(parser, bytes, n, in_place); msg; msg = get_next_fix_message(parser))
+	{
+		struct batch_message tmp;
+		struct batch_message* p;
+
+		if(batch->size == batch->capacity)
+			grow_message_batch(batch);
+
+		p = &batch->messages[batch->size++];
+		tmp = *p;
+		p->message = parser->message;
+		p->buffer = parser->buffer;
+		parser->message = tmp.message;
+		parser->buffer = tmp.buffer;
+	}
+
+	for(i = 0; i < batch->size; ++i)
+		batch->list[i] = &batch->messages[i].message.properties;
+
+	if(p_count)
+		*p_count = batch->size;
+
+	return batch->list;
+}
+
+const struct fix_message* const* get_fix_message_batch(struct fix_parser* parser, const void* bytes, size_t n, size_t* p_count)
+{
+	return run_batch(parser, bytes, n, NO, p_count);
+}
+
+const struct fix_message* const* get_fix_message_batch_in_place(struct fix_parser* parser, void* bytes, size_t n, size_t* p_count)
+{
+	return run_batch(parser, bytes, n, YES, p_count);
+}
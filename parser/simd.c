@@ -0,0 +1,281 @@
+/*
+Copyright (c) 2013, 2014, 2015, Maxim Konakov
+ All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list
+   of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, this list
+   of conditions and the following disclaimer in the documentation and/or other materials
+   provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY
+AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "fix_parser_impl.h"
+
+#include <malloc.h>
+
+#ifdef _WIN32
+#define STRICT
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// instruction sets -------------------------------------------------------------------------------
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(HAVE_SSE2) && (defined(_MSC_VER) || defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef HAVE_AVX2
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_FUNC
+#else
+#define AVX2_FUNC __attribute__((target("avx2")))
+#endif
+
+static
+boolean cpu_has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+
+	__cpuid(info, 0);
+
+	if(info[0] < 7)
+		return NO;
+
+	__cpuid(info, 1);
+
+	if((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)	// OSXSAVE and YMM state
+		return NO;
+
+	__cpuidex(info, 7, 0);
+
+	return (info[1] & (1 << 5)) ? YES : NO;
+#else
+	return __builtin_cpu_supports("avx2") ? YES : NO;
+#endif
+}
+
+#endif	// HAVE_AVX2
+
+// structural index -------------------------------------------------------------------------------
+// scalar version
+static
+void scan_bytes(uint64_t* soh, uint64_t* eq, const char* s, size_t n)
+{
+	size_t i;
+	uint64_t soh_mask = 0, eq_mask = 0;
+
+	for(i = 0; i < n; ++i)
+	{
+		soh_mask |= (uint64_t)(s[i] == SOH) << i;
+		eq_mask |= (uint64_t)(s[i] == '=') << i;
+	}
+
+	*soh = soh_mask;
+	*eq = eq_mask;
+}
+
+static
+void scan_blocks_scalar(uint64_t* soh, uint64_t* eq, const char* s, size_t num_blocks)
+{
+	size_t i;
+
+	for(i = 0; i < num_blocks; ++i, s += 64)
+		scan_bytes(&soh[i], &eq[i], s, 64);
+}
+
+#ifdef HAVE_SSE2
+
+#define SSE2_MASK(v, x)	\
+	(uint64_t)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8((v), (x)))
+
+static
+void scan_blocks_sse2(uint64_t* soh, uint64_t* eq, const char* s, size_t num_blocks)
+{
+	size_t i;
+	const __m128i soh_v = _mm_set1_epi8(SOH), eq_v = _mm_set1_epi8('=');
+
+	for(i = 0; i < num_blocks; ++i, s += 64)
+	{
+		const __m128i
+			v0 = _mm_loadu_si128((const __m128i*)s),
+			v1 = _mm_loadu_si128((const __m128i*)(s + 16)),
+			v2 = _mm_loadu_si128((const __m128i*)(s + 32)),
+			v3 = _mm_loadu_si128((const __m128i*)(s + 48));
+
+		soh[i] = SSE2_MASK(v0, soh_v) | (SSE2_MASK(v1, soh_v) << 16) | (SSE2_MASK(v2, soh_v) << 32) | (SSE2_MASK(v3, soh_v) << 48);
+		eq[i] = SSE2_MASK(v0, eq_v) | (SSE2_MASK(v1, eq_v) << 16) | (SSE2_MASK(v2, eq_v) << 32) | (SSE2_MASK(v3, eq_v) << 48);
+	}
+}
+
+#endif	// HAVE_SSE2
+
+#ifdef HAVE_AVX2
+
+#define AVX2_MASK(v, x)	\
+	(uint64_t)(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8((v), (x)))
+
+AVX2_FUNC static
+void scan_blocks_avx2(uint64_t* soh, uint64_t* eq, const char* s, size_t num_blocks)
+{
+	size_t i;
+	const __m256i soh_v = _mm256_set1_epi8(SOH), eq_v = _mm256_set1_epi8('=');
+
+	for(i = 0; i < num_blocks; ++i, s += 64)
+	{
+		const __m256i
+			v0 = _mm256_loadu_si256((const __m256i*)s),
+			v1 = _mm256_loadu_si256((const __m256i*)(s + 32));
+
+		soh[i] = AVX2_MASK(v0, soh_v) | (AVX2_MASK(v1, soh_v) << 32);
+		eq[i] = AVX2_MASK(v0, eq_v) | (AVX2_MASK(v1, eq_v) << 32);
+	}
+}
+
+#endif	// HAVE_AVX2
+
+// message start ---------------------------------------------------------------------------------
+static const char message_prefix[] = "8=FIX";
+
+#define PREFIX_LEN (sizeof(message_prefix) - 1)
+
+const char* find_message_start(const char* s, const char* end)
+{
+	size_t i;
+
+#ifdef HAVE_SSE2
+	const __m128i c0 = _mm_set1_epi8('8'), c1 = _mm_set1_epi8('='), c2 = _mm_set1_epi8('F'), c3 = _mm_set1_epi8('I'), c4 = _mm_set1_epi8('X');
+
+	for(; end - s >= 16 + (ptrdiff_t)PREFIX_LEN - 1; s += 16)
+	{
+		unsigned mask =
+			(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)s), c0))
+			& (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(s + 1)), c1))
+			& (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(s + 2)), c2))
+			& (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(s + 3)), c3))
+			& (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(s + 4)), c4));
+
+		if(mask != 0)
+		{
+			for(; (mask & 1) == 0; mask >>= 1)
+				++s;
+
+			return s;
+		}
+	}
+#endif
+
+	// scalar version, also accepting a partial match at the end
+	for(; s < end; ++s)
+	{
+		for(i = 0; i < PREFIX_LEN && s + i < end && s[i] == message_prefix[i]; ++i);
+
+		if(i == PREFIX_LEN || s + i == end)
+			return s;
+	}
+
+	return end;
+}
+
+// kernel selection -------------------------------------------------------------------------------
+struct simd_kernels
+{
+	void (*scan_blocks)(uint64_t* soh, uint64_t* eq, const char* s, size_t num_blocks);
+};
+
+static struct simd_kernels kernels;
+
+static
+void select_kernels()
+{
+	kernels.scan_blocks = &scan_blocks_scalar;
+
+#ifdef HAVE_SSE2
+	kernels.scan_blocks = &scan_blocks_sse2;
+#endif
+
+#ifdef HAVE_AVX2
+	if(cpu_has_avx2())
+		kernels.scan_blocks = &scan_blocks_avx2;
+#endif
+}
+
+// the kernels get selected once, on the first use from any thread
+#ifdef _WIN32
+
+static INIT_ONCE kernels_once = INIT_ONCE_STATIC_INIT;
+
+static
+BOOL CALLBACK select_kernels_once(PINIT_ONCE once, PVOID param, PVOID* context)
+{
+	(void)once;
+	(void)param;
+	(void)context;
+
+	select_kernels();
+	return TRUE;
+}
+
+static
+const struct simd_kernels* get_kernels()
+{
+	InitOnceExecuteOnce(&kernels_once, select_kernels_once, NULL, NULL);
+	return &kernels;
+}
+
+#else	// pthreads
+
+static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+
+static
+const struct simd_kernels* get_kernels()
+{
+	pthread_once(&kernels_once, select_kernels);
+	return &kernels;
+}
+
+#endif	// pthreads
+
+void build_structural_index(struct structural_index* index, const char* s, size_t n)
+{
+	const size_t num_blocks = n / 64, num_words = (n + 63) / 64;
+
+	if(index->capacity < num_words)
+	{
+		index->soh = REALLOC(uint64_t, index->soh, num_words);
+		index->eq = REALLOC(uint64_t, index->eq, num_words);
+		index->capacity = num_words;
+	}
+
+	get_kernels()->scan_blocks(index->soh, index->eq, s, num_blocks);
+
+	if(num_blocks < num_words)
+		scan_bytes(&index->soh[num_blocks], &index->eq[num_blocks], s + 64 * num_blocks, n % 64);
+}
+
+void free_structural_index(struct structural_index* index)
+{
+	FREE(index->soh);
+	FREE(index->eq);
+}
@@ -34,6 +34,11 @@ int is_alnum(int c)
 	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 }
 
+boolean is_message_separator(int c)
+{
+	return (c == '\n' || c == '\r' || c == ' ' || c == '\t') ? YES : NO;
+}
+
 NOINLINE static
 void report_splitter_error(struct fix_parser* parser, const char* fmt, ...)
 {
@@ -43,6 +48,9 @@ void report_splitter_error(struct fix_parser* parser, const char* fmt, ...)
 	va_list args;
 	char buff[1000];
 
+	if(parser->recovery.enabled)
+		return;	// the splitter is going to resynchronise instead
+
 	va_start(args, fmt);
 	n = VSPRINTF_S(buff, sizeof(buff), fmt, args);
 
@@ -61,10 +69,35 @@ void report_unexpected_symbol(struct fix_parser* parser, int c)
 		report_splitter_error(parser, "Unexpected byte 0x%X in FIX message", c);
 }
 
+// splitter recovery
+static
+void report_skipped_bytes(struct fix_parser* parser)
+{
+	struct recovery_data* const r = &parser->recovery;
+
+	r->total += r->skipped;
+
+	if(r->on_skip)
+		r->on_skip(r->context, r->skipped);
+
+	r->skipped = 0;
+}
+
+// message bytes up to the end of the input chunk, kept in the raw messages mode
+static
+void save_message_bytes(struct fix_parser* parser, const char* mark, const char* s)
+{
+	if(parser->raw_messages)
+		append_bytes_to_string_buffer(&parser->message.raw, mark, (size_t)(s - mark));
+}
+
+// checksum trailer "10=xxx" SOH
+#define TRAILER_LEN 7
+
 // macro for the splitter
 #define _STATE_LABEL(l)	\
 	case l:	\
-		if(s == end) { sp->state = l; parser->ptr = end; return; } else ((void)0)
+		if(s == end) { sp->state = l; sp->message_bytes += (size_t)(end - mark); save_message_bytes(parser, mark, end); parser->ptr = end; return; } else ((void)0)
 
 #define STATE_LABEL	_STATE_LABEL(__COUNTER__)
 
@@ -78,16 +111,16 @@ void report_unexpected_symbol(struct fix_parser* parser, int c)
 
 #define MATCH(x)	\
 	NEXT_CHAR();	\
-	if(c != (x)) { report_unexpected_symbol(parser, c); return; } else ((void)0)
+	if(c != (x)) { report_unexpected_symbol(parser, c); goto RECOVER; } else ((void)0)
 
 #define MATCH_CS(x)	\
 	NEXT_CHAR_CS();	\
-	if(c != (x)) { report_unexpected_symbol(parser, c); return; } else ((void)0)
+	if(c != (x)) { report_unexpected_symbol(parser, c); goto RECOVER; } else ((void)0)
 
 #define UPDATE_BYTE_COUNT()	\
 	if(--sp->byte_counter == 0) {	\
 		report_splitter_error(parser, "Unexpected end of FIX message");	\
-		return;	\
+		goto RECOVER;	\
 	} else ((void)0)
 
 #define MATCH_CS_COUNTED(x)	\
@@ -105,7 +138,7 @@ void report_unexpected_symbol(struct fix_parser* parser, int c)
 #define END_MATCH	\
 	default:	\
 		report_unexpected_symbol(parser, (char)c);	\
-		return;	\
+		goto RECOVER;	\
 	}
 
 void read_message(struct fix_parser* parser)
@@ -115,9 +148,41 @@ void read_message(struct fix_parser* parser)
 	struct splitter_data* const sp = &parser->splitter;
 	const char* s = parser->ptr;
 	const char* const end = parser->end;
+	const char* mark = s;	// either the beginning of the message or the beginning of the input chunk
 
+RESTART:
 	switch(sp->state)
 	{
+		case SPLITTER_RESYNC:
+			mark = find_message_start(s, end);
+			parser->recovery.skipped += (size_t)(mark - s);
+
+			if(mark == end)
+			{
+				parser->ptr = end;
+				return;
+			}
+
+			report_skipped_bytes(parser);
+			s = mark;
+			sp->state = 0;
+			// fall through
+
+		case __COUNTER__:	// message boundary
+			if(parser->skip_separators)
+			{
+				while(s != end && is_message_separator(CHAR_TO_INT(*s)))
+					++s;
+
+				if(s == end)
+				{
+					parser->ptr = end;
+					return;
+				}
+
+				mark = s;
+			}
+
 		MATCH_CS('8');
 		MATCH_CS('=');
 		MATCH_CS('F');
@@ -190,7 +255,7 @@ void read_message(struct fix_parser* parser)
 					if(sp->byte_counter > MAX_MESSAGE_LEN)
 					{
 						report_splitter_error(parser, "FIX message longer than " STR(MAX_MESSAGE_LEN) " bytes");
-						return;
+						goto RECOVER;
 					}
 
 					break;
@@ -199,7 +264,7 @@ void read_message(struct fix_parser* parser)
 					if(sp->byte_counter < 5)
 					{
 						report_splitter_error(parser, "Invalid FIX message length: %Iu", sp->byte_counter);
-						return;
+						goto RECOVER;
 					}
 
 					goto MSG_TYPE;
@@ -223,7 +288,7 @@ void read_message(struct fix_parser* parser)
 				if(sp->counter > 2)
 				{
 					report_splitter_error(parser, "Invalid FIX message type");
-					return;
+					goto RECOVER;
 				}
 
 				parser->message.properties.type[sp->counter++] = (char)c;
@@ -233,38 +298,87 @@ void read_message(struct fix_parser* parser)
 				if(sp->counter == 0)
 				{
 					report_splitter_error(parser, "Invalid FIX message type");
-					return;
+					goto RECOVER;
 				}
 
 				parser->message.properties.type[sp->counter] = 0;
-				string_buffer_ensure_capacity(&parser->buffer, sp->byte_counter);
+
+				if(parser->filter.accept)
+					sp->skip = parser->filter.accept(parser->filter.context, parser->message.properties.version, parser->message.properties.type) ? NO : YES;
+
 				break;
 			}
 			else
 			{
 				report_unexpected_symbol(parser, c);
-				return;
+				goto RECOVER;
 			}
 		}
 
-		// copy message body
-		while(sp->byte_counter > 0)
-		{
-			STATE_LABEL;
-			n = (size_t)(end - s);
+		// message body
+		if(sp->skip)
+		{	// rejected message, only count the bytes
+			while(sp->byte_counter > 0)
+			{
+				STATE_LABEL;
+				n = (size_t)(end - s);
+
+				if(sp->byte_counter < n)
+					n = sp->byte_counter;
+
+				if(parser->filter.verify_checksum)
+					sp->check_sum += get_checksum(s, n);
+
+				s += n;
+				sp->byte_counter -= n;
+			}
+
+			// the last body byte is always in the current chunk
+			if(s[-1] != SOH)
+			{
+				report_splitter_error(parser, "FIX message body is not terminated with SOH");
+				goto RECOVER;
+			}
+
+			goto CHECK_SUM;
+		}
+		else if(parser->in_place && sp->byte_counter + TRAILER_LEN <= (size_t)(end - s))
+		{	// the whole body and the trailer are in the input chunk, parse the body from there
+			parser->body = (char*)s;
+			parser->body_size = sp->byte_counter;
+			sp->check_sum += get_checksum(s, sp->byte_counter);
+			s += sp->byte_counter;
+			sp->byte_counter = 0;
+		}
+		else
+		{	// copy message body
+			string_buffer_ensure_capacity(&parser->buffer, sp->byte_counter);
+
+			while(sp->byte_counter > 0)
+			{
+				STATE_LABEL;
+				n = (size_t)(end - s);
 
-			if(sp->byte_counter < n)
-				n = sp->byte_counter;
+				if(sp->byte_counter < n)
+					n = sp->byte_counter;
 
-			sp->check_sum += append_bytes_to_string_buffer_with_checksum(&parser->buffer, s, n);
-			s += n;
-			sp->byte_counter -= n;
+				sp->check_sum += append_bytes_to_string_buffer_with_checksum(&parser->buffer, s, n);
+				s += n;
+				sp->byte_counter -= n;
+			}
+
+			parser->body = parser->buffer.str;
+			parser->body_size = parser->buffer.size;
 		}
 
-		if(parser->buffer.size > 0 && parser->buffer.str[parser->buffer.size - 1] != SOH)
+		if(parser->body_size > 0 && parser->body[parser->body_size - 1] != SOH)
+		{
 			report_splitter_error(parser, "FIX message body is not terminated with SOH");
+			goto RECOVER;
+		}
 
 		// checksum
+	CHECK_SUM:
 		MATCH('1');
 		MATCH('0');
 		MATCH('=');
@@ -285,14 +399,24 @@ void read_message(struct fix_parser* parser)
 					sp->their_sum = sp->their_sum * 10 + (char)(c - '0');
 					break;
 				case SOH:
-					if(sp->counter != 3 || sp->their_sum != sp->check_sum)
+					if(sp->counter != 3 || (sp->their_sum != sp->check_sum && (!sp->skip || parser->filter.verify_checksum)))
 					{
 						report_splitter_error(parser, "Invalid FIX message checksum");
-						return;
+						goto RECOVER;
+					}
+
+					if(sp->skip)
+					{	// carry on with the next message
+						++parser->filter.skipped;
+						set_buffer_empty(&parser->message.raw);
+						INIT_SPLITTER(sp);
+						mark = s;
+						goto RESTART;
 					}
 
 					// all done
 					parser->ptr = s;
+					save_message_bytes(parser, mark, s);	// before the parser overwrites SOH
 					parse_message(parser);
 					INIT_SPLITTER(sp);
 					return;
@@ -300,10 +424,33 @@ void read_message(struct fix_parser* parser)
 		}
 
 		report_unexpected_symbol(parser, c);
-		return;
+		goto RECOVER;
 
 		// should never get here
 		default:
 			report_splitter_error(parser, "Invalid FIX splitter state %d", sp->state);
 	}
+
+RECOVER:
+	if(!parser->recovery.enabled)
+		return;
+
+	// restart from the byte next to the beginning of the broken message, or from the beginning
+	// of the input chunk if the message started in one of the previous chunks
+	if(sp->message_bytes == 0)
+	{
+		s = mark + 1;
+		parser->recovery.skipped += 1;
+	}
+	else
+	{
+		s = mark;
+		parser->recovery.skipped += sp->message_bytes;
+	}
+
+	set_buffer_empty(&parser->buffer);
+	set_buffer_empty(&parser->message.raw);
+	INIT_SPLITTER(sp);
+	sp->state = SPLITTER_RESYNC;
+	goto RESTART;
 }
@@ -25,32 +25,83 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 
 #include <assert.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 void init_tag_reader(struct fix_parser* parser, struct tag_reader* reader)
 {
 	assert(parser);
 	assert(reader);
 
-	reader->ptr = parser->buffer.str;
-	reader->end = parser->buffer.str + parser->buffer.size;
+	build_structural_index(&parser->index, parser->body, parser->body_size);
+
+	reader->base = reader->ptr = parser->body;
+	reader->end = parser->body + parser->body_size;
+	reader->soh = parser->index.soh;
+	reader->eq = parser->index.eq;
 	reader->has_unread_tag = NO;
+	reader->skip_mode = NO;
 	reader->recursion_level = 0u;
 	reader->parser = parser;
 }
 
 #define ERROR_RETURN(code) return (reader->end = reader->ptr = NULL, code)
 
+// structural index lookup
+static
+unsigned count_trailing_zeros(uint64_t x)
+{
+#if defined(__GNUC__)
+	return (unsigned)__builtin_ctzll(x);
+#elif defined(_M_X64)
+	unsigned long i;
+
+	_BitScanForward64(&i, x);
+	return (unsigned)i;
+#else
+	unsigned long i;
+
+	if(_BitScanForward(&i, (unsigned long)x))
+		return (unsigned)i;
+
+	_BitScanForward(&i, (unsigned long)(x >> 32));
+	return (unsigned)i + 32;
+#endif
+}
+
+// returns pointer to the first byte marked in the bitmap at or after s, or reader->end if none
+static
+char* find_next(const struct tag_reader* reader, const uint64_t* bitmap, char* s)
+{
+	const size_t pos = (size_t)(s - reader->base), num_words = ((size_t)(reader->end - reader->base) + 63) / 64;
+	size_t i = pos / 64;
+	uint64_t w = bitmap[i] & (~(uint64_t)0 << (pos % 64));
+
+	while(w == 0)
+	{
+		if(++i == num_words)
+			return (char*)reader->end;
+
+		w = bitmap[i];
+	}
+
+	return reader->base + 64 * i + count_trailing_zeros(w);
+}
+
 static
 tag_reader_status read_tag(struct tag_reader* reader)
 {
-	char* s = reader->ptr;
+	char *s = reader->ptr, *eq;
 
 	if(s >= reader->end)
 		return TR_DONE;
 
 	// tag
-	s = (char*)read_fix_uint(s, reader->end, &reader->current.tag);
+	eq = find_next(reader, reader->eq, s);
+	s = (char*)read_fix_uint(s, eq, &reader->current.tag);
 
-	if(!s || *s != '=' || ++s == reader->end)
+	if(s != eq || s == reader->end || ++s == reader->end)
 	{
 		report_message_error(reader->parser, "Invalid tag format");
 		ERROR_RETURN(TR_ERROR);
@@ -80,8 +131,7 @@ tag_reader_status read_next_tag(struct tag_reader* reader)
 	if(r != TR_OK)
 		return r;
 
-	//s = (char*)memchr(reader->ptr, SOH, reader->end - reader->ptr);
-	for(s = reader->ptr; s < reader->end && *s != SOH; ++s);
+	s = find_next(reader, reader->soh, reader->ptr);
 
 	if(s == reader->end)
 	{
@@ -98,8 +148,10 @@ tag_reader_status read_next_tag(struct tag_reader* reader)
 		ERROR_RETURN(TR_ERROR);
 	}
 
-	*s++ = 0;	// replacing SOH
-	reader->ptr = s;
+	if(!reader->skip_mode)
+		*s = 0;	// replacing SOH
+
+	reader->ptr = s + 1;
 	reader->current.group = NULL;
 
 	return TR_OK;
@@ -136,7 +188,9 @@ tag_reader_status read_binary_tag(struct tag_reader* reader, size_t tag)
 		ERROR_RETURN(TR_ERROR);
 	}
 
-	*(reader->ptr + len) = 0;	// replacing SOH
+	if(!reader->skip_mode)
+		*(reader->ptr + len) = 0;	// replacing SOH
+
 	reader->current.length = len;
 	reader->current.value = reader->ptr;
 	reader->current.group = NULL;
@@ -28,6 +28,7 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 extern void all_simple_tests();
 extern void all_group_tests();
 extern void all_mixed_tests();
+extern void all_simd_tests();
 
 int main()
 {
@@ -37,6 +38,7 @@ int main()
 
 	try
 	{
+		all_simd_tests();
 		all_simple_tests();
 		all_group_tests();
 		all_mixed_tests();
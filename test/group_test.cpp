@@ -24,6 +24,9 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 #include "test_messages.h"
 
 #include <string>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
 
 // message
 // test
@@ -54,6 +57,1092 @@ void simple_group_test2()
 	free_fix_parser(parser);
 }
 
+static
+void arena_test()
+{
+	const std::string s(copy_message_with_groups(3));
+	fix_parser* parser = create_fix_parser(message_with_groups_classifier);
+	const arena_block* block = nullptr;
+	size_t counter = 0;
+
+	for(const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size()); pm; pm = get_next_fix_message(parser))
+	{
+		ensure(pm->error == nullptr);
+		validate_message_with_groups(pm);
+
+		// group nodes must reuse the same memory for every message
+		const arena* const pa = parser->message.arena;
+
+		ensure(pa->first != nullptr && pa->current == pa->first);
+
+		if(block)
+			ensure(pa->first == block);
+		else
+			block = pa->first;
+
+		++counter;
+	}
+
+	ensure(counter == 3);
+	ensure(!get_fix_parser_error(parser));
+	free_fix_parser(parser);
+}
+
+// sizes that overflow must fail instead of allocating a wrapped-around amount
+static
+void arena_overflow_test()
+{
+	arena a = { nullptr, nullptr, 0 };
+	table_cache cache = { nullptr, 0, 0 };
+	fix_group_node origin;
+
+	ZERO_FILL(&origin);
+
+	ensure(arena_alloc(&a, (size_t)-1) == nullptr);
+	ensure(arena_alloc(&a, (size_t)-1 - 7) == nullptr);
+	ensure(a.first == nullptr);
+
+	const fix_node_table* const table = get_node_table(&cache, message_with_groups_classifier(FIX_4_2, "X"));
+
+	ensure(alloc_group_nodes(&a, table, (size_t)-1 / sizeof(fix_group_node) + 1, &origin) == nullptr);
+	ensure(alloc_group_nodes(&a, table, (size_t)-1 / sizeof(tag_slot), &origin) == nullptr);
+	ensure(a.first == nullptr);
+
+	fix_group_node* const nodes = alloc_group_nodes(&a, table, 2, &origin);
+
+	ensure(nodes && nodes->next == nodes + 1);
+
+	free_table_cache(&cache);
+	free_arena(&a);
+}
+
+// tag streaming
+struct stream_trace
+{
+	std::string events;
+	size_t stop_at;	// tag to stop at, or 0
+};
+
+static
+int trace_tag(void* context, fix_tag_event event, const fix_tag* pt)
+{
+	stream_trace* const trace = (stream_trace*)context;
+	char buff[30];
+
+	switch(event)
+	{
+	case FIX_TAG:
+		sprintf(buff, "%u ", (unsigned)pt->tag);
+		break;
+	case FIX_GROUP_BEGIN:
+		sprintf(buff, "[%u:%u ", (unsigned)pt->tag, (unsigned)pt->length);
+		break;
+	case FIX_GROUP_NODE:
+		strcpy(buff, "| ");
+		break;
+	case FIX_GROUP_END:
+		strcpy(buff, "] ");
+		break;
+	default:
+		strcpy(buff, "? ");
+		break;
+	}
+
+	trace->events.append(buff);
+
+	return (pt->tag != trace->stop_at) ? 1 : 0;
+}
+
+static
+void streaming_test()
+{
+	const std::string s(copy_message_with_groups(2));
+	fix_parser* parser = create_fix_parser(message_with_groups_classifier);
+	stream_trace trace;
+	const char* const expected = "49 56 34 52 262 [268:2 "
+								 "| 279 269 278 55 270 15 271 346 "
+								 "| 279 269 278 55 270 15 271 346 ] ";
+
+	trace.stop_at = 0;
+	set_fix_tag_callback(parser, trace_tag, &trace);
+
+	const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	ensure(pm);
+	ensure(pm->error == nullptr);
+	ensure(pm->type[0] == 'X' && pm->type[1] == 0);
+	ensure(get_fix_node_size(get_fix_message_root_node(pm)) == 0);
+	ensure(trace.events == expected);
+
+	// stop in the middle of the message
+	trace.events.clear();
+	trace.stop_at = 262;
+	pm = get_next_fix_message(parser);
+
+	ensure(pm);
+	ensure(pm->error == nullptr);
+	ensure(trace.events == "49 56 34 52 262 ");
+	ensure(!get_next_fix_message(parser));
+	ensure(!get_fix_parser_error(parser));
+
+	// back to the normal mode
+	trace.events.clear();
+	set_fix_tag_callback(parser, nullptr, nullptr);
+	pm = get_first_fix_message(parser, message_with_groups, message_with_groups_size);
+
+	ensure(pm);
+	ensure(pm->error == nullptr);
+	validate_message_with_groups(pm);
+	ensure(trace.events.empty());
+	free_fix_parser(parser);
+}
+
+static size_t num_streamed_tags = 0;
+
+static
+int count_tags(void*, fix_tag_event event, const fix_tag*)
+{
+	if(event == FIX_TAG)
+		++num_streamed_tags;
+
+	return 1;
+}
+
+static
+void set_streaming_mode(fix_parser* parser)
+{
+	set_fix_tag_callback(parser, count_tags, nullptr);
+}
+
+static
+void validate_streamed_message(const fix_message* pm)
+{
+	ensure(pm->type[0] == 'X');
+}
+
+static
+void validate_message_header(const fix_message* pm)
+{
+	const fix_group_node* const root = get_fix_message_root_node(pm);
+
+	ensure(pm->type[0] == 'X');
+	ensure(get_fix_tag(root, 34) && get_fix_tag(root, 56));
+}
+
+static
+void mode_speed_test(const char* test_type, void (*set_mode)(fix_parser*), void (*validator)(const fix_message*))
+{
+	const size_t M = 10;
+	const std::string s(copy_message_with_groups(M));
+
+	const size_t step = 101, 
+#ifdef _DEBUG
+		N = 1000;
+#else
+		N = 100000;
+#endif
+
+	const char* const end = s.c_str() + s.size();
+	fix_parser* const parser = create_fix_parser(message_with_groups_classifier);
+	size_t count = 0;
+
+	set_mode(parser);
+
+	const clock_t t_start = clock();
+
+	for(size_t i = 0; i < N; ++i)
+	{
+		for(const char* p = s.c_str(); p < end; p += step)
+		{
+			for(const fix_message* pm = get_first_fix_message(parser, p, std::min(step, (size_t)(end - p))); pm; pm = get_next_fix_message(parser))
+			{
+				ensure(!pm->error);
+				validator(pm);
+				++count;
+			}
+	
+			ensure(!get_fix_parser_error(parser));
+		}
+	}
+
+	const clock_t t_end = clock();
+
+	free_fix_parser(parser);
+	ensure(count == N * M);
+
+	print_running_time(test_type, N * M, t_start, t_end);
+}
+
+static
+void streaming_speed_test()
+{
+	num_streamed_tags = 0;
+	mode_speed_test("Message with groups, streaming", set_streaming_mode, validate_streamed_message);
+	ensure(num_streamed_tags > 0 && num_streamed_tags % 21 == 0);
+}
+
+// interest set
+GROUP_NODE(filtered_node, 279)
+	VALID_TAGS(filtered_node)
+		TAG(279)
+		TAG(269)
+		TAG(278)
+		TAG(55)
+		TAG(270)
+		TAG(15)
+		TAG(271)
+		TAG(346)
+	END_VALID_TAGS
+
+	INTERESTING_TAGS(filtered_node)
+		TAG(269)
+		TAG(270)
+	END_INTERESTING_TAGS
+
+	NO_DATA_TAGS(filtered_node)
+	NO_GROUPS(filtered_node)
+END_FILTERED_NODE(filtered_node);
+
+MESSAGE(filtered_root)
+	VALID_TAGS(filtered_root)
+		TAG(49)
+		TAG(56)
+		TAG(34)
+		TAG(52)
+		TAG(262)
+		TAG(268)
+	END_VALID_TAGS
+
+	INTERESTING_TAGS(filtered_root)
+		TAG(34)
+		TAG(268)
+	END_INTERESTING_TAGS
+
+	NO_DATA_TAGS(filtered_root)
+
+	GROUPS(filtered_root)
+		GROUP_TAG(268, filtered_node)
+	END_GROUPS
+END_FILTERED_MESSAGE(filtered_root);
+
+MESSAGE(header_only_root)
+	VALID_TAGS(header_only_root)
+		TAG(49)
+		TAG(56)
+		TAG(34)
+		TAG(52)
+		TAG(262)
+		TAG(268)
+	END_VALID_TAGS
+
+	INTERESTING_TAGS(header_only_root)
+		TAG(49)
+		TAG(56)
+		TAG(34)
+	END_INTERESTING_TAGS
+
+	NO_DATA_TAGS(header_only_root)
+
+	GROUPS(header_only_root)
+		GROUP_TAG(268, filtered_node)
+	END_GROUPS
+END_FILTERED_MESSAGE(header_only_root);
+
+static
+const fix_tag_classifier* filtered_classifier(fix_message_version, const char* msg_type)
+{
+	return (msg_type[0] == 'X' && msg_type[1] == 0) ? PARSER_TABLE_ADDRESS(filtered_root) : nullptr;
+}
+
+static
+const fix_tag_classifier* header_only_classifier(fix_message_version, const char* msg_type)
+{
+	return (msg_type[0] == 'X' && msg_type[1] == 0) ? PARSER_TABLE_ADDRESS(header_only_root) : nullptr;
+}
+
+// group with many nodes
+static
+std::string make_book_message(size_t n)
+{
+	std::string s("8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "49=A\x01" "56=B\x01" "262=A\x01" "268=");
+
+	s.append(std::to_string(n)).append("\x01");
+
+	for(size_t i = 0; i < n; ++i)
+		s.append("279=0\x01" "269=").append(i % 2 ? "1" : "0").append("\x01" "270=1.5\x01" "271=").append(std::to_string(i)).append("\x01");
+
+	return make_fix_message(s.c_str());
+}
+
+static
+void ensure_book(const fix_message* pm, size_t n)
+{
+	ensure(pm && !pm->error);
+
+	const fix_group_node* const group = get_fix_tag(get_fix_message_root_node(pm), 268)->group;
+	const fix_group_node* node = group;
+
+	ensure(get_fix_group_size(group) == n);
+	ensure(get_fix_group_entry(group, n) == nullptr);
+
+	for(size_t i = 0; i < n; ++i, node = get_next_fix_node(node))
+	{
+		const fix_group_node* const entry = get_fix_group_entry(group, i);
+
+		ensure(entry == node);
+		ensure(get_fix_node_size(entry) == 4);
+		ensure_tag(entry, 271, std::to_string(i).c_str());
+		ensure_tag(entry, 269, i % 2 ? "1" : "0");
+
+		ensure(entry == group + i);
+	}
+
+	ensure(node == nullptr);
+}
+
+static
+void contiguous_group_test()
+{
+	const size_t n = 500;
+	const std::string s(make_book_message(n));
+
+	fix_parser* parser = create_fix_parser(message_with_groups_classifier);
+	const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	ensure_book(pm, n);
+	ensure(get_fix_group_size(get_fix_message_root_node(pm)) == 0);
+	ensure(!get_next_fix_message(parser));
+	free_fix_parser(parser);
+
+	// single node group
+	const std::string m(make_book_message(1));
+
+	parser = create_fix_parser(message_with_groups_classifier);
+	ensure_book(get_first_fix_message(parser, m.c_str(), m.size()), 1);
+	free_fix_parser(parser);
+}
+
+// group counts far beyond the message size must fail without allocating the nodes
+static
+void ensure_huge_group_count(classifier_func classifier, void (*set_mode)(fix_parser*), const char* count)
+{
+	const std::string s(make_fix_message((std::string("8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "49=A\x01" "268=") + count
+										  + "\x01" "279=0\x01" "269=0\x01" "34=12\x01").c_str()));
+
+	fix_parser* const parser = create_fix_parser(classifier);
+
+	if(set_mode)
+		set_mode(parser);
+
+	const fix_message* const pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	ensure(pm && pm->error && strstr(pm->error, "Unexpected end of message while reading a group node"));
+	ensure(!get_next_fix_message(parser));
+	free_fix_parser(parser);
+}
+
+static
+void huge_group_count_test()
+{
+	static const char* const counts[] = { "1000000000000", "18446744073709551615", "10000000", "9" };
+
+	for(size_t i = 0; i < sizeof(counts)/sizeof(counts[0]); ++i)
+	{
+		ensure_huge_group_count(message_with_groups_classifier, nullptr, counts[i]);
+		ensure_huge_group_count(message_with_groups_classifier, set_streaming_mode, counts[i]);
+		ensure_huge_group_count(header_only_classifier, nullptr, counts[i]);
+	}
+}
+
+// lazy groups
+GROUP_NODE(lazy_inner, 448)
+	VALID_TAGS(lazy_inner)
+		TAG(448)
+		TAG(447)
+	END_VALID_TAGS
+
+	NO_DATA_TAGS(lazy_inner)
+	NO_GROUPS(lazy_inner)
+END_NODE(lazy_inner);
+
+GROUP_NODE(lazy_outer, 279)
+	VALID_TAGS(lazy_outer)
+		TAG(279)
+		TAG(269)
+		TAG(278)
+		TAG(453)
+	END_VALID_TAGS
+
+	NO_DATA_TAGS(lazy_outer)
+
+	GROUPS(lazy_outer)
+		GROUP_TAG(453, lazy_inner)
+	END_GROUPS
+END_NODE(lazy_outer);
+
+MESSAGE(lazy_root)
+	VALID_TAGS(lazy_root)
+		TAG(49)
+		TAG(56)
+		TAG(34)
+		TAG(58)
+		TAG(268)
+	END_VALID_TAGS
+
+	NO_DATA_TAGS(lazy_root)
+
+	GROUPS(lazy_root)
+		GROUP_TAG(268, lazy_outer)
+	END_GROUPS
+END_MESSAGE(lazy_root);
+
+static
+const fix_tag_classifier* nested_group_classifier(fix_message_version, const char* msg_type)
+{
+	return (msg_type[0] == 'X' && msg_type[1] == 0) ? PARSER_TABLE_ADDRESS(lazy_root) : nullptr;
+}
+
+// nested group in the middle of the message
+static const char nested_group_message[] = "8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "49=A\x01" "56=B\x01" "268=2\x01"
+	"279=0\x01" "269=0\x01" "453=2\x01" "448=P1\x01" "447=D\x01" "448=P2\x01" "447=D\x01" "278=BID\x01"
+	"279=0\x01" "269=1\x01" "453=1\x01" "448=P3\x01" "447=D\x01" "278=OFFER\x01" "34=12\x01" "58=done\x01";
+
+static
+void validate_nested_group_message(const fix_message* pm)
+{
+	ensure(pm && !pm->error);
+
+	const fix_group_node* const root = get_fix_message_root_node(pm);
+
+	ensure(get_fix_node_size(root) == 5);
+	ensure_tag(root, 34, "12");
+	ensure_tag(root, 58, "done");
+
+	const fix_group_node* const group = get_fix_group(root, 268);
+
+	ensure(get_fix_group_size(group) == 2);
+	ensure(get_fix_node_size(group) == 4 && get_fix_node_size(group + 1) == 4);
+	ensure_tag(group, 278, "BID");
+	ensure_tag(group + 1, 278, "OFFER");
+	ensure(get_fix_node_tag(group, 2)->tag == 453 && get_fix_node_tag(group, 3)->tag == 278);
+
+	const fix_group_node* inner = get_fix_group(group, 453);
+
+	ensure(get_fix_group_size(inner) == 2);
+	ensure_tag(inner, 448, "P1");
+	ensure_tag(get_fix_group_entry(inner, 1), 448, "P2");
+
+	inner = get_fix_group(group + 1, 453);
+
+	ensure(get_fix_group_size(inner) == 1);
+	ensure_tag(inner, 448, "P3");
+	ensure_tag(inner, 447, "D");
+}
+
+static
+void set_lazy_mode(fix_parser* parser)
+{
+	enable_fix_parser_lazy_groups(parser);
+}
+
+// the group tag record has no nodes until the group gets accessed
+static
+bool is_lazy_group(const fix_message* pm, size_t i)
+{
+	const fix_group_node* const root = get_fix_message_root_node(pm);
+
+	return root->lazy && root->tags[i].value == nullptr && root->tags[i].group == nullptr;
+}
+
+static
+void lazy_group_test()
+{
+	const std::string s(make_fix_message(nested_group_message));
+
+	// same result in both modes
+	fix_parser* parser = create_fix_parser(nested_group_classifier);
+	const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	validate_nested_group_message(pm);
+	free_fix_parser(parser);
+
+	parser = create_fix_parser(nested_group_classifier);
+	set_lazy_mode(parser);
+	pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	ensure(pm && !pm->error);
+	ensure(is_lazy_group(pm, 2));
+	ensure_tag(get_fix_message_root_node(pm), 58, "done");
+	ensure(is_lazy_group(pm, 2));
+	validate_nested_group_message(pm);
+	ensure(get_fix_message_root_node(pm)->lazy == nullptr);
+	ensure(!get_next_fix_message(parser));
+	free_fix_parser(parser);
+
+	// built on the wire order iteration, as one contiguous array
+	const size_t n = 500;
+	const std::string m(make_book_message(n));
+
+	parser = create_fix_parser(message_with_groups_classifier);
+	set_lazy_mode(parser);
+	pm = get_first_fix_message(parser, m.c_str(), m.size());
+
+	ensure(pm && !pm->error && is_lazy_group(pm, 3));
+	ensure(get_fix_node_tag(get_fix_message_root_node(pm), 3)->group != nullptr);
+	ensure_book(pm, n);
+	free_fix_parser(parser);
+
+	// batch mode moves the messages with their pending groups
+	std::string b;
+
+	for(size_t i = 0; i < 20; ++i)
+		b.append(s);
+
+	parser = create_fix_parser(nested_group_classifier);
+	set_lazy_mode(parser);
+
+	size_t count = 0;
+	const fix_message* const* const batch = get_fix_message_batch(parser, b.c_str(), b.size(), &count);
+
+	ensure(count == 20);
+
+	for(size_t i = 0; i < count; ++i)
+		ensure(is_lazy_group(batch[i], 2));
+
+	for(size_t i = 0; i < count; ++i)
+		validate_nested_group_message(batch[i]);
+
+	ensure(!get_fix_parser_error(parser));
+	free_fix_parser(parser);
+}
+
+// errors inside a lazy group leave the group without nodes, instead of failing the message
+static
+void ensure_invalid_lazy_group(const char* group, const char* error)
+{
+	const std::string s(make_fix_message((std::string("8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "49=A\x01" "56=B\x01") + group
+										  + "34=12\x01" "58=done\x01").c_str()));
+
+	fix_parser* parser = create_fix_parser(nested_group_classifier);
+	const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	ensure(pm && pm->error && strstr(pm->error, error));
+	free_fix_parser(parser);
+
+	parser = create_fix_parser(nested_group_classifier);
+	set_lazy_mode(parser);
+	pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	ensure(pm && !pm->error);
+
+	const fix_group_node* const root = get_fix_message_root_node(pm);
+
+	ensure(get_fix_group(root, 268) == nullptr);
+	ensure(get_fix_tag(root, 268) && get_fix_tag(root, 268)->group == nullptr);
+	ensure(root->lazy == nullptr);
+	ensure_tag(root, 34, "12");
+	ensure_tag(root, 58, "done");
+	ensure(!get_next_fix_message(parser));
+	free_fix_parser(parser);
+}
+
+static
+void invalid_lazy_group_test()
+{
+	ensure_invalid_lazy_group("268=3\x01" "279=0\x01" "269=0\x01" "279=0\x01" "269=1\x01", "Unexpected tag 34");
+	ensure_invalid_lazy_group("268=1\x01" "279=0\x01" "269=0\x01" "279=0\x01" "269=1\x01", "Unexpected tag 279");
+	ensure_invalid_lazy_group("268=1\x01" "279=0\x01" "269=0\x01" "269=1\x01", "Duplicate tag 269");
+	ensure_invalid_lazy_group("268=1\x01" "279=0\x01" "453=2\x01" "448=P1\x01" "447=D\x01", "Unexpected tag 34");
+}
+
+static
+void compact_tag_test()
+{
+	ensure(sizeof(tag_slot) == 16);
+
+	const std::string s(copy_message_with_groups());
+	fix_parser* parser = create_fix_parser(message_with_groups_classifier);
+	const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	ensure(pm && !pm->error);
+
+	const fix_group_node* const root = get_fix_message_root_node(pm);
+	size_t length = 0;
+	const char* const value = get_fix_tag_value(root, 52, &length);
+
+	// value access
+	ensure(value && length == 21 && strcmp(value, "20100318-03:21:11.364") == 0);
+	ensure(get_fix_tag_value(root, 268, &length) == nullptr);	// group tag
+	ensure(get_fix_tag_value(root, 50, &length) == nullptr);	// no tag
+
+	// group access
+	const fix_group_node* const group = get_fix_group(root, 268);
+
+	ensure(group && get_fix_group_size(group) == 2);
+	ensure(get_fix_group(root, 52) == nullptr);
+	ensure(strcmp(get_fix_tag_value(get_fix_group_entry(group, 1), 278, nullptr), "OFFER") == 0);
+
+	// struct fix_tag records are stable and consistent with the accessors
+	const fix_tag* const pt = get_fix_tag(root, 268);
+
+	ensure(pt && pt->tag == 268 && pt->length == 2 && pt->value == nullptr && pt->group == group);
+	ensure(get_fix_tag(root, 34) && get_fix_tag(root, 34) == get_fix_tag(root, 34));
+	ensure(pt == get_fix_tag(root, 268) && pt->group == group);
+	ensure(get_fix_tag(root, 52)->value == value && get_fix_tag(root, 52)->group == nullptr);
+	ensure(!get_next_fix_message(parser));
+	free_fix_parser(parser);
+
+	// duplicate group
+	const std::string d(make_fix_message("8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "268=1\x01" "279=0\x01" "268=1\x01" "279=1\x01"));
+
+	parser = create_fix_parser(message_with_groups_classifier);
+	pm = get_first_fix_message(parser, d.c_str(), d.size());
+	ensure(pm && pm->error && strstr(pm->error, "Duplicate tag 268"));
+	free_fix_parser(parser);
+}
+
+static
+void interest_set_test()
+{
+	const std::string s(copy_message_with_groups(2));
+	fix_parser* parser = create_fix_parser(filtered_classifier);
+	const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	ensure(pm);
+	ensure(pm->error == nullptr);
+
+	const fix_group_node* node = get_fix_message_root_node(pm);
+
+	ensure(get_fix_node_size(node) == 2);
+	ensure_tag(node, 34, "12");
+	ensure(!get_fix_tag(node, 49) && !get_fix_tag(node, 262));
+
+	size_t i = 0;
+
+	for(node = ensure_group_tag(node, 268, 2); node; node = get_next_fix_node(node), ++i)
+	{
+		ensure(get_fix_node_size(node) == 2);
+		ensure_tag(node, 269, i == 0 ? "0" : "1");
+		ensure_tag(node, 270, i == 0 ? "1.37215" : "1.37224");
+		ensure(!get_fix_tag(node, 279) && !get_fix_tag(node, 278));
+	}
+
+	ensure(i == 2);
+	free_fix_parser(parser);
+
+	// the group is validated, but not stored
+	parser = create_fix_parser(header_only_classifier);
+
+	for(pm = get_first_fix_message(parser, s.c_str(), s.size()), i = 0; pm; pm = get_next_fix_message(parser), ++i)
+	{
+		ensure(pm->error == nullptr);
+		node = get_fix_message_root_node(pm);
+		ensure(get_fix_node_size(node) == 3);
+		ensure_tag(node, 49, "A");
+		ensure_tag(node, 56, "B");
+		ensure_tag(node, 34, "12");
+		ensure(!get_fix_tag(node, 268));
+	}
+
+	ensure(i == 2);
+	ensure(!get_fix_parser_error(parser));
+	free_fix_parser(parser);
+
+	// errors inside a skipped group are still detected
+	const std::string m(make_fix_message("8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "49=A\x01" "268=2\x01" "279=0\x01" "269=0\x01" "34=12\x01"));
+
+	parser = create_fix_parser(header_only_classifier);
+	pm = get_first_fix_message(parser, m.c_str(), m.size());
+	ensure(pm && pm->error);
+	free_fix_parser(parser);
+}
+
+static
+void filtered_speed_test()
+{
+	test_for_speed("Message with groups, header tags only", header_only_classifier, copy_message_with_groups, validate_message_header);
+}
+
+// header tags only, with the groups built or left unbuilt
+static
+void set_eager_mode(fix_parser*)
+{
+}
+
+static
+void lazy_speed_test()
+{
+	mode_speed_test("Message with groups, eager groups, header tags only", set_eager_mode, validate_message_header);
+	mode_speed_test("Message with groups, lazy groups, header tags only", set_lazy_mode, validate_message_header);
+}
+
+// node tables
+static unsigned char node_valid[(347 + 7) / 8], node_special[(347 + 7) / 8], root_valid[(269 + 7) / 8], root_special[(269 + 7) / 8];
+
+static const fix_node_table node_table_spec = { 279, 347, node_valid, node_special, nullptr, nullptr, 0, nullptr, 0, nullptr };
+static const fix_group_entry root_groups[] = { { 268, &node_table_spec } };
+static const fix_node_table root_table_spec = { 0, 269, root_valid, root_special, nullptr, nullptr, 0, root_groups, 1, nullptr };
+static const fix_tag_classifier table_classifier = { nullptr, nullptr, nullptr, nullptr, nullptr, &root_table_spec };
+
+static
+void set_bit(unsigned char* bits, size_t tag)
+{
+	bits[tag / 8] |= (unsigned char)(1u << (tag % 8));
+}
+
+static
+const fix_tag_classifier* get_table_classifier(fix_message_version, const char* msg_type)
+{
+	return (msg_type[0] == 'X' && msg_type[1] == 0) ? &table_classifier : nullptr;
+}
+
+static
+void node_table_test()
+{
+	const size_t root_tags[] = { 49, 56, 34, 52, 262, 268 }, node_tags[] = { 279, 269, 278, 55, 270, 15, 271, 346 };
+
+	for(size_t i = 0; i < sizeof(root_tags) / sizeof(root_tags[0]); ++i)
+		set_bit(root_valid, root_tags[i]);
+
+	for(size_t i = 0; i < sizeof(node_tags) / sizeof(node_tags[0]); ++i)
+		set_bit(node_valid, node_tags[i]);
+
+	set_bit(root_special, 268);
+
+	// table-driven classifier
+	const std::string s(copy_message_with_groups(2));
+	fix_parser* parser = create_fix_parser(get_table_classifier);
+	size_t n = 0;
+
+	for(const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size()); pm; pm = get_next_fix_message(parser), ++n)
+	{
+		ensure(pm->error == nullptr);
+		validate_message_with_groups(pm);
+
+		const fix_group_node* const node = get_fix_message_root_node(pm);
+
+		ensure(get_fix_node_size(node) == 6);
+		ensure_tag(get_next_fix_node(ensure_group_tag(node, 268, 2)), 278, "OFFER");
+	}
+
+	ensure(n == 2);
+	ensure(!get_fix_parser_error(parser));
+	free_fix_parser(parser);
+
+	// tags outside the table are invalid
+	const std::string m(make_fix_message("8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "49=A\x01" "1000=X\x01"));
+
+	parser = create_fix_parser(get_table_classifier);
+
+	const fix_message* const pm = get_first_fix_message(parser, m.c_str(), m.size());
+
+	ensure(pm && pm->error && strstr(pm->error, "Unexpected tag 1000"));
+	free_fix_parser(parser);
+
+	// classifier compiled into a table
+	table_cache cache = { nullptr, 0, 0 };
+	const fix_node_table* const root = get_node_table(&cache, message_with_groups_classifier(FIX_4_2, "X"));
+
+	ensure(root->first_tag == 0 && root->max_tag == 269 && root->fallback != nullptr);
+	ensure(root->num_data_tags == 0 && root->num_groups == 1 && root->groups[0].length_tag == 268);
+	ensure(memcmp(root->valid, root_valid, sizeof(root_valid)) == 0);
+	ensure(memcmp(root->special, root_special, sizeof(root_special)) == 0);
+
+	const fix_node_table* const node = root->groups[0].node;
+
+	ensure(node->first_tag == 279 && node->max_tag == 347 && node->num_groups == 0);
+	ensure(memcmp(node->valid, node_valid, sizeof(node_valid)) == 0);
+	ensure(root->ranks && root->ranks[sizeof(root_valid)] == 6 && root->ranks[48 / 8] == 1 && root->ranks[56 / 8] == 3);
+	ensure(node->ranks && node->ranks[sizeof(node_valid)] == 8 && node->ranks[0] == 0);
+	ensure(get_node_table(&cache, message_with_groups_classifier(FIX_4_2, "X")) == root);
+	ensure(cache.size == 1);
+
+	// compiled once per process, shared by the caches of all parsers
+	table_cache other_cache = { nullptr, 0, 0 };
+
+	ensure(get_node_table(&other_cache, message_with_groups_classifier(FIX_4_2, "X")) == root);
+
+	// a different classifier at an address seen before
+	fix_tag_classifier reused = *message_with_groups_classifier(FIX_4_2, "X");
+	const fix_node_table* const filtered = get_node_table(&other_cache, PARSER_TABLE_ADDRESS(filtered_root));
+
+	ensure(filtered != root && filtered->interesting != nullptr);
+	ensure(get_node_table(&cache, &reused) == root);
+	reused = *PARSER_TABLE_ADDRESS(filtered_root);
+	ensure(get_node_table(&cache, &reused) == filtered);
+	ensure(get_node_table(&cache, &reused) == filtered);
+	ensure(cache.size == 2);
+
+	free_table_cache(&other_cache);
+	free_table_cache(&cache);
+}
+
+// group length tag above MAX_COMPILED_TAG
+static
+int high_root_valid(size_t tag)
+{
+	return tag == 49 || tag == 56 || tag == 70000;
+}
+
+static
+int high_node_valid(size_t tag)
+{
+	return tag == 279 || tag == 269;
+}
+
+static
+size_t no_data_tag(size_t)
+{
+	return 0;
+}
+
+static
+int high_root_first(size_t)
+{
+	return 0;
+}
+
+static
+int high_node_first(size_t tag)
+{
+	return tag == 279;
+}
+
+static
+const fix_tag_classifier* no_group(size_t)
+{
+	return nullptr;
+}
+
+static const fix_tag_classifier* high_root_group(size_t tag);
+
+static const fix_tag_classifier high_node_classifier = { high_node_valid, no_data_tag, high_node_first, no_group, nullptr, nullptr };
+static const fix_tag_classifier high_root_classifier = { high_root_valid, no_data_tag, high_root_first, high_root_group, nullptr, nullptr };
+
+static
+const fix_tag_classifier* high_root_group(size_t tag)
+{
+	return (tag == 70000) ? &high_node_classifier : nullptr;
+}
+
+static
+const fix_tag_classifier* get_high_group_classifier(fix_message_version, const char*)
+{
+	return &high_root_classifier;
+}
+
+static
+void unsupported_group_test()
+{
+	const std::string m(make_fix_message("8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "49=A\x01" "56=B\x01" "70000=1\x01" "279=0\x01" "269=1\x01"));
+	fix_parser* const parser = create_fix_parser(get_high_group_classifier);
+	const fix_message* const pm = get_first_fix_message(parser, m.c_str(), m.size());
+
+	ensure(pm && pm->error && strstr(pm->error, "Unsupported group tag 70000"));
+	ensure(!get_next_fix_message(parser));
+	free_fix_parser(parser);
+}
+
+// classifier generated by fixgen from test/FIX42-test.xml, test/FIX44-test.xml, test/FIXT11-test.xml
+// and test/FIX50-test.xml (see test/test_dictionary.c)
+extern "C" const fix_tag_classifier* test_dictionary_classifier(fix_message_version version, const char* msg_type);
+
+static
+void dictionary_test()
+{
+	// dispatch
+	ensure(test_dictionary_classifier(FIX_4_2, "X") != nullptr);
+	ensure(test_dictionary_classifier(FIX_4_2, "5") != nullptr);
+	ensure(test_dictionary_classifier(FIX_4_4, "D") != nullptr);
+	ensure(test_dictionary_classifier(FIX_4_4, "c") != nullptr);
+	ensure(test_dictionary_classifier(FIX_4_4, "AT") != nullptr);
+	ensure(test_dictionary_classifier(FIX_4_4, "A") == nullptr);
+	ensure(test_dictionary_classifier(FIX_4_4, "ATX") == nullptr);
+	ensure(test_dictionary_classifier(FIX_4_2, "D") == nullptr);
+	ensure(test_dictionary_classifier(FIX_4_3, "D") == nullptr);
+	ensure(test_dictionary_classifier(FIX_5_0, "X") == nullptr);
+	ensure(test_dictionary_classifier(FIX_5_0, "8") != nullptr);
+	ensure(test_dictionary_classifier(FIX_5_0, "D") != nullptr && test_dictionary_classifier(FIX_5_0, "D") != test_dictionary_classifier(FIX_4_4, "D"));
+	ensure(test_dictionary_classifier(FIX_5_0, "A") != nullptr);	// session messages from the transport dictionary
+	ensure(test_dictionary_classifier(FIX_5_0, "0") != nullptr);
+	ensure(test_dictionary_classifier(FIX_5_0, "5") == nullptr);
+
+	// messages with and without groups
+	std::string s(copy_message_with_groups(2));
+
+	s.append(copy_simple_message(2));
+
+	fix_parser* parser = create_fix_parser(test_dictionary_classifier);
+	size_t n = 0;
+
+	for(const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size()); pm; pm = get_next_fix_message(parser), ++n)
+	{
+		ensure(pm->error == nullptr);
+
+		if(n < 2)
+		{
+			validate_message_with_groups(pm);
+			ensure(get_fix_node_size(get_fix_message_root_node(pm)) == 6);
+			ensure(get_fix_tag(get_fix_message_root_node(pm), 50) == nullptr);	// between the valid tags
+			ensure(get_fix_tag(get_fix_message_root_node(pm), 96) == nullptr);	// valid, but not in the message
+			ensure_tag(get_next_fix_node(ensure_group_tag(get_fix_message_root_node(pm), 268, 2)), 278, "OFFER");
+		}
+		else
+			validate_simple_message(pm);
+	}
+
+	ensure(n == 4);
+	ensure(!get_fix_parser_error(parser));
+	free_fix_parser(parser);
+
+	// data tags in the message body and in the trailer
+	const std::string m(make_fix_message("8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "49=A\x01" "95=3\x01" "96=a\x01z\x01" "93=2\x01" "89=\x01\x01\x01"));
+
+	parser = create_fix_parser(test_dictionary_classifier);
+
+	const fix_message* pm = get_first_fix_message(parser, m.c_str(), m.size());
+
+	ensure(pm && !pm->error);
+
+	const fix_tag* const raw = get_fix_tag(get_fix_message_root_node(pm), 96);
+	const fix_tag* const sig = get_fix_tag(get_fix_message_root_node(pm), 89);
+
+	ensure(raw && raw->length == 3 && memcmp(raw->value, "a\x01z", 3) == 0);
+	ensure(sig && sig->length == 2 && memcmp(sig->value, "\x01\x01", 2) == 0);
+	free_fix_parser(parser);
+
+	// tags from the other messages are invalid
+	const std::string e(make_fix_message("8=FIX.4.4\x01" "9=0\x01" "35=c\x01" "49=A\x01" "11=X\x01"));
+
+	parser = create_fix_parser(test_dictionary_classifier);
+	pm = get_first_fix_message(parser, e.c_str(), e.size());
+	ensure(pm && pm->error && strstr(pm->error, "Unexpected tag 11"));
+	free_fix_parser(parser);
+
+	// FIX 5.0 application messages with the FIXT 1.1 header and trailer, and the FIXT session messages
+	const std::string f(make_fix_message("8=FIXT.1.1\x01" "9=0\x01" "35=8\x01" "49=A\x01" "56=B\x01" "34=7\x01" "1128=7\x01"
+										 "37=O1\x01" "17=E1\x01" "150=0\x01" "39=0\x01" "453=2\x01" "448=P1\x01" "452=1\x01" "448=P2\x01" "452=3\x01"
+										 "54=1\x01" "151=100\x01" "14=0\x01")
+						+ make_fix_message("8=FIXT.1.1\x01" "9=0\x01" "35=A\x01" "49=A\x01" "56=B\x01" "34=1\x01"
+										   "98=0\x01" "108=30\x01" "95=3\x01" "96=a\x01z\x01" "1137=7\x01"));
+
+	parser = create_fix_parser(test_dictionary_classifier);
+	pm = get_first_fix_message(parser, f.c_str(), f.size());
+
+	ensure(pm && !pm->error && pm->version == FIX_5_0 && strcmp(pm->type, "8") == 0);
+	ensure_tag(get_fix_message_root_node(pm), 1128, "7");
+	ensure_tag(get_fix_message_root_node(pm), 14, "0");
+	ensure_tag(get_fix_group_entry(ensure_group_tag(get_fix_message_root_node(pm), 453, 2), 1), 448, "P2");
+
+	pm = get_next_fix_message(parser);
+
+	ensure(pm && !pm->error && pm->version == FIX_5_0 && strcmp(pm->type, "A") == 0);
+	ensure_tag(get_fix_message_root_node(pm), 108, "30");
+	ensure(get_fix_tag(get_fix_message_root_node(pm), 96) && get_fix_tag(get_fix_message_root_node(pm), 96)->length == 3);
+	ensure(!get_next_fix_message(parser));
+	free_fix_parser(parser);
+
+	// the transport session messages do not take the application tags
+	const std::string g(make_fix_message("8=FIXT.1.1\x01" "9=0\x01" "35=0\x01" "49=A\x01" "56=B\x01" "34=2\x01" "37=O1\x01"));
+
+	parser = create_fix_parser(test_dictionary_classifier);
+	pm = get_first_fix_message(parser, g.c_str(), g.size());
+	ensure(pm && pm->error && strstr(pm->error, "Unexpected tag 37"));
+	free_fix_parser(parser);
+}
+
+// wire order iteration, with the tags stored in the rank slots and in the hash table
+static unsigned char wide_valid[(2100 + 7) / 8], wide_special[(2100 + 7) / 8];
+static const fix_node_table wide_table_spec = { 0, 2100, wide_valid, wide_special, nullptr, nullptr, 0, nullptr, 0, nullptr };
+static const fix_tag_classifier wide_classifier = { nullptr, nullptr, nullptr, nullptr, nullptr, &wide_table_spec };
+
+static
+const fix_tag_classifier* get_wide_classifier(fix_message_version, const char*)
+{
+	return &wide_classifier;
+}
+
+static
+void ensure_wire_order(const fix_group_node* node, const char* s)
+{
+	size_t i = 0;
+
+	for(const char* p = s; *p; p = strchr(p, '\x01') + 1, ++i)
+	{
+		const fix_tag* const pt = get_fix_node_tag(node, i);
+
+		ensure(pt);
+		ensure(pt->tag == (size_t)atoi(p));
+		ensure(pt == get_fix_tag(node, pt->tag));
+
+		if(pt->group)
+			ensure(pt->value == nullptr && pt->length == get_fix_group_size(pt->group));
+		else
+			ensure(pt->length == (size_t)(strchr(p, '\x01') - strchr(p, '=') - 1) && memcmp(pt->value, strchr(p, '=') + 1, pt->length) == 0);
+	}
+
+	ensure(i == get_fix_node_size(node));
+	ensure(get_fix_node_tag(node, i) == nullptr);
+}
+
+static
+void ensure_message_with_groups_order(const fix_message* pm)
+{
+	ensure(pm && !pm->error);
+
+	const fix_group_node* const root = get_fix_message_root_node(pm);
+
+	ensure_wire_order(root, "49=A\x01" "56=B\x01" "34=12\x01" "52=20100318-03:21:11.364\x01" "262=A\x01" "268=2\x01");
+	ensure_wire_order(get_fix_node_tag(root, 5)->group, "279=0\x01" "269=0\x01" "278=BID\x01" "55=EUR/USD\x01" "270=1.37215\x01" "15=EUR\x01" "271=2500000\x01" "346=1\x01");
+	ensure_wire_order(get_fix_group_entry(get_fix_group(root, 268), 1), "279=0\x01" "269=1\x01" "278=OFFER\x01" "55=EUR/USD\x01" "270=1.37224\x01" "15=EUR\x01" "271=2503200\x01" "346=1\x01");
+}
+
+static
+void wire_order_test()
+{
+	// rank slots
+	fix_parser* parser = create_fix_parser(message_with_groups_classifier);
+	const fix_message* pm = get_first_fix_message(parser, message_with_groups, message_with_groups_size);
+
+	ensure_message_with_groups_order(pm);
+	free_fix_parser(parser);
+
+	// batch mode, where the messages get moved out of the parser after parsing
+	const std::string s(copy_message_with_groups(5));
+	size_t n = 0;
+
+	parser = create_fix_parser(message_with_groups_classifier);
+
+	const fix_message* const* const batch = get_fix_message_batch(parser, s.c_str(), s.size(), &n);
+
+	ensure(n == 5);
+
+	for(size_t i = 0; i < n; ++i)
+		ensure_message_with_groups_order(batch[i]);
+
+	free_fix_parser(parser);
+
+	// hash table, getting expanded
+	std::string body;
+
+	for(size_t tag = 2099; tag >= 2000; tag -= 3)
+		body.append(std::to_string(tag)).append("=v").append(std::to_string(tag)).append("\x01");
+
+	body.append("7=x\x01" "1000=y\x01" "3=z\x01");
+
+	for(size_t tag = 1; tag < 2100; ++tag)
+		wide_valid[tag / 8] |= (unsigned char)(1u << (tag % 8));
+
+	const std::string m(make_fix_message(("8=FIX.4.4\x01" "9=0\x01" "35=W\x01" + body).c_str()));
+
+	parser = create_fix_parser(get_wide_classifier);
+	pm = get_first_fix_message(parser, m.c_str(), m.size());
+	ensure(pm && !pm->error);
+	ensure(get_fix_node_size(get_fix_message_root_node(pm)) == 37);
+	ensure_wire_order(get_fix_message_root_node(pm), body.c_str());
+	free_fix_parser(parser);
+}
+
 static 
 void speed_test()
 {
@@ -65,5 +1154,21 @@ void all_group_tests()
 {
 	simple_group_test();
 	simple_group_test2();
+	arena_test();
+	arena_overflow_test();
+	streaming_test();
+	contiguous_group_test();
+	huge_group_count_test();
+	lazy_group_test();
+	invalid_lazy_group_test();
+	compact_tag_test();
+	wire_order_test();
+	interest_set_test();
+	node_table_test();
+	unsupported_group_test();
+	dictionary_test();
 	speed_test();
+	streaming_speed_test();
+	filtered_speed_test();
+	lazy_speed_test();
 }
\ No newline at end of file
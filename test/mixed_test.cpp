@@ -23,6 +23,8 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 
 #include "test_messages.h"
 
+#include <vector>
+
 static
 std::string create_test_data(size_t n)
 {
@@ -80,6 +82,352 @@ void validate_mixed_message(const fix_message* pm)
 #endif
 }
 
+static
+void batch_test()
+{
+	const size_t M = 10;
+	const std::string s(create_test_data(M));
+	fix_parser* const parser = create_fix_parser(mixed_message_classifier);
+	const size_t step = 1000;
+	size_t counter = 0;
+
+	for(size_t i = 0; i < s.size(); i += step)
+	{
+		size_t n;
+		const fix_message* const* batch = get_fix_message_batch(parser, s.c_str() + i, std::min(step, s.size() - i), &n);
+
+		ensure(!get_fix_parser_error(parser));
+
+		// all messages in the batch must be valid at the same time
+		for(size_t j = 0; j < n; ++j)
+		{
+			ensure(!batch[j]->error);
+			ensure(batch[j]->type[0] == (((counter + j) & 1u) != 0 ? 'X' : 'D'));
+			validate_mixed_message(batch[j]);
+		}
+
+		counter += n;
+	}
+
+	free_fix_parser(parser);
+	ensure(counter == M);
+}
+
+// message filter test
+static
+int accept_orders(void* context, fix_message_version version, const char* msg_type)
+{
+	++*(size_t*)context;
+	return (version == FIX_4_4 && msg_type[0] == 'D' && msg_type[1] == 0) ? 1 : 0;
+}
+
+static
+void message_filter_test(size_t step, int verify_checksum)
+{
+	const size_t M = 11;
+	const std::string s(create_test_data(M));
+	fix_parser* const parser = create_fix_parser(mixed_message_classifier);
+	size_t num_calls = 0, counter = 0;
+
+	set_fix_message_filter(parser, accept_orders, &num_calls, verify_checksum);
+
+	for(size_t i = 0; i < s.size(); i += step)
+	{
+		for(const fix_message* pm = get_first_fix_message(parser, s.c_str() + i, std::min(step, s.size() - i)); pm; pm = get_next_fix_message(parser))
+		{
+			ensure(!pm->error);
+			ensure(pm->type[0] == 'D');
+			validate_mixed_message(pm);
+			++counter;
+		}
+
+		ensure(!get_fix_parser_error(parser));
+	}
+
+	ensure(num_calls == M);
+	ensure(counter == M / 2 + 1);
+	ensure(get_fix_parser_filtered_count(parser) == M / 2);
+	free_fix_parser(parser);
+}
+
+static
+void message_filter_checksum_test()
+{
+	std::string s(create_test_data(3));
+	const size_t pos = s.find("10=", s.find("35=X"));
+
+	ensure(pos != std::string::npos);
+	s[pos + 5] = (s[pos + 5] == '0') ? '1' : '0';	// invalid checksum in the skipped message
+
+	for(int verify = 0; verify < 2; ++verify)
+	{
+		fix_parser* const parser = create_fix_parser(mixed_message_classifier);
+		size_t num_calls = 0, counter = 0;
+
+		set_fix_message_filter(parser, accept_orders, &num_calls, verify);
+
+		for(const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size()); pm; pm = get_next_fix_message(parser))
+			++counter;
+
+		if(verify)
+			ensure(get_fix_parser_error(parser) && counter == 1);
+		else
+			ensure(!get_fix_parser_error(parser) && counter == 2);
+
+		free_fix_parser(parser);
+	}
+}
+
+// raw messages test
+static
+void ensure_raw_message(const fix_message* pm, size_t index)
+{
+	const std::string expected(((index & 1u) != 0) ? copy_message_with_groups() : copy_simple_message());
+	size_t n = 0;
+	const char* const raw = get_fix_message_raw(pm, &n);
+
+	ensure(raw != nullptr);
+	ensure(std::string(raw, n) == expected);
+}
+
+static
+void raw_message_test(size_t step, bool in_place)
+{
+	const size_t M = 11;
+	std::string s(create_test_data(M));
+	fix_parser* const parser = create_fix_parser(mixed_message_classifier);
+	size_t counter = 0;
+
+	enable_fix_parser_raw_messages(parser);
+
+	for(size_t i = 0; i < s.size(); i += step)
+	{
+		const size_t n = std::min(step, s.size() - i);
+
+		for(const fix_message* pm = in_place ? get_first_fix_message_in_place(parser, &s[i], n) : get_first_fix_message(parser, s.c_str() + i, n);
+			pm;
+			pm = get_next_fix_message(parser))
+		{
+			ensure(!pm->error);
+			validate_mixed_message(pm);
+			ensure_raw_message(pm, counter++);
+		}
+
+		ensure(!get_fix_parser_error(parser));
+	}
+
+	free_fix_parser(parser);
+	ensure(counter == M);
+}
+
+static
+void raw_message_batch_test()
+{
+	const size_t M = 10;
+	const std::string s(create_test_data(M));
+	fix_parser* const parser = create_fix_parser(mixed_message_classifier);
+	const size_t step = 700;
+	size_t counter = 0;
+
+	enable_fix_parser_raw_messages(parser);
+
+	for(size_t i = 0; i < s.size(); i += step)
+	{
+		size_t n;
+		const fix_message* const* batch = get_fix_message_batch(parser, s.c_str() + i, std::min(step, s.size() - i), &n);
+
+		ensure(!get_fix_parser_error(parser));
+
+		for(size_t j = 0; j < n; ++j)
+			ensure_raw_message(batch[j], counter + j);
+
+		counter += n;
+	}
+
+	free_fix_parser(parser);
+	ensure(counter == M);
+}
+
+static
+void raw_message_filter_test(size_t step)
+{
+	const size_t M = 11;
+	const std::string s(create_test_data(M));
+	fix_parser* const parser = create_fix_parser(mixed_message_classifier);
+	size_t num_calls = 0, counter = 0;
+
+	set_fix_message_filter(parser, accept_orders, &num_calls, 1);
+	enable_fix_parser_raw_messages(parser);
+
+	for(size_t i = 0; i < s.size(); i += step)
+	{
+		for(const fix_message* pm = get_first_fix_message(parser, s.c_str() + i, std::min(step, s.size() - i)); pm; pm = get_next_fix_message(parser))
+		{
+			ensure(!pm->error);
+			ensure(pm->type[0] == 'D');
+			ensure_raw_message(pm, 2 * counter++);	// every other message is filtered out
+		}
+	}
+
+	free_fix_parser(parser);
+	ensure(counter == M / 2 + 1);
+}
+
+static
+void raw_message_disabled_test()
+{
+	const std::string s(copy_simple_message());
+	fix_parser* const parser = create_fix_parser(mixed_message_classifier);
+	const fix_message* const pm = get_first_fix_message(parser, s.c_str(), s.size());
+	size_t n = 42;
+
+	ensure(pm && !pm->error);
+	ensure(get_fix_message_raw(pm, &n) == nullptr);
+	ensure(n == 42);
+	free_fix_parser(parser);
+}
+
+// log file test
+struct log_region_result
+{
+	std::string types;
+	size_t errors;
+};
+
+static
+void log_file_handler(void* context, const fix_message* pm)
+{
+	log_region_result* const res = (log_region_result*)context;
+
+	// do not throw from a worker thread
+	if(pm->error || pm->type[1] != 0)
+		++res->errors;
+	else
+		res->types.push_back(pm->type[0]);
+}
+
+// writes the bytes to a file and replays it, returns the error or an empty string
+static
+std::string replay_log_file(const std::string& s, log_region_result* results, size_t num_threads, classifier_func cf = mixed_message_classifier)
+{
+	const char* const file_name = "log_file_test.fix";
+
+	FILE* const file = fopen(file_name, "wb");
+
+	ensure(file);
+	ensure(fwrite(s.c_str(), 1, s.size(), file) == s.size());
+	ensure(fclose(file) == 0);
+
+	std::vector<void*> contexts(num_threads);
+
+	for(size_t i = 0; i < num_threads; ++i)
+	{
+		results[i].types.clear();
+		results[i].errors = 0;
+		contexts[i] = &results[i];
+	}
+
+	const char* const error = parse_fix_log_file(file_name, cf, num_threads, log_file_handler, &contexts[0]);
+
+	remove(file_name);
+	return error ? error : "";
+}
+
+static
+void ensure_log_messages(const log_region_result* results, size_t num_threads, size_t M)
+{
+	std::string types;
+
+	for(size_t i = 0; i < num_threads; ++i)
+	{
+		ensure(results[i].errors == 0 && !results[i].types.empty());
+		types.append(results[i].types);
+	}
+
+	ensure(types.size() == M);
+
+	for(size_t i = 0; i < M; ++i)
+		ensure(types[i] == (((i & 1u) != 0) ? 'X' : 'D'));
+}
+
+static
+void log_file_test()
+{
+	const size_t M = 1001, num_threads = 4;
+	log_region_result results[num_threads];
+	void* contexts[num_threads] = {};
+
+	const std::string error(replay_log_file(create_test_data(M), results, num_threads));
+
+	ensure_msg(error.empty(), error.c_str());
+	ensure_log_messages(results, num_threads, M);
+	ensure(parse_fix_log_file("no-such-file.fix", mixed_message_classifier, num_threads, log_file_handler, contexts) != NULL);
+}
+
+// one message per line, with both kinds of line breaks
+static
+void log_file_lines_test()
+{
+	const size_t M = 1001, num_threads = 4;
+	log_region_result results[num_threads];
+	std::string s;
+
+	for(size_t i = 0; i < M; ++i)
+		s.append(((i & 1u) != 0) ? copy_message_with_groups() : copy_simple_message()).append((i % 3 == 0) ? "\r\n" : "\n");
+
+	const std::string error(replay_log_file(s, results, num_threads));
+
+	ensure_msg(error.empty(), error.c_str());
+	ensure_log_messages(results, num_threads, M);
+}
+
+// the parser error gets passed on to the caller
+static
+void log_file_error_test()
+{
+	const size_t num_threads = 1;
+	log_region_result results[num_threads];
+	const std::string s(copy_simple_message() + "\n" + copy_simple_message() + "\nxyz\n" + copy_simple_message());
+
+	const std::string error(replay_log_file(s, results, num_threads));
+
+	ensure_msg(error.find("Unexpected byte 'x'") != std::string::npos, error.c_str());
+	ensure(results[0].types == "DD");
+}
+
+// messages inside a data field must not be taken for region boundaries
+extern "C" const fix_tag_classifier* test_dictionary_classifier(fix_message_version version, const char* msg_type);
+
+static
+void log_file_embedded_message_test()
+{
+	const size_t M = 101, num_threads = 4;
+	log_region_result results[num_threads];
+	std::string data("x\x01"), s;
+
+	for(size_t i = 0; i < 3; ++i)
+		data.append(copy_simple_message());
+
+	const std::string m(make_fix_message(("8=FIX.4.2\x01" "9=0\x01" "35=X\x01" "49=A\x01" "95=" + std::to_string(data.size()) + "\x01" "96=" + data + "\x01").c_str()));
+
+	for(size_t i = 0; i < M; ++i)
+		s.append(m).append("\n");
+
+	const std::string error(replay_log_file(s, results, num_threads, test_dictionary_classifier));
+	std::string types;
+
+	ensure_msg(error.empty(), error.c_str());
+
+	for(size_t i = 0; i < num_threads; ++i)
+	{
+		ensure(results[i].errors == 0);
+		types.append(results[i].types);
+	}
+
+	ensure(types == std::string(M, 'X'));
+	ensure(!results[num_threads - 1].types.empty());
+}
+
 static
 void mixed_speed_test()
 {
@@ -89,5 +437,22 @@ void mixed_speed_test()
 // batch
 void all_mixed_tests()
 {
+	batch_test();
+	message_filter_test(1000, 0);
+	message_filter_test(7, 1);
+	message_filter_test(1, 0);
+	message_filter_checksum_test();
+	raw_message_test(1000, false);
+	raw_message_test(7, false);
+	raw_message_test(1, false);
+	raw_message_test(1000, true);
+	raw_message_test(5, true);
+	raw_message_batch_test();
+	raw_message_filter_test(7);
+	raw_message_disabled_test();
+	log_file_test();
+	log_file_lines_test();
+	log_file_error_test();
+	log_file_embedded_message_test();
 	mixed_speed_test();
 }
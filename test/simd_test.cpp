@@ -0,0 +1,405 @@
+/*
+Copyright (c) 2013, 2014, 2015, Maxim Konakov
+ All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list 
+   of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, this list 
+   of conditions and the following disclaimer in the documentation and/or other materials 
+   provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY 
+AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER 
+OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "test_messages.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HAVE_RDTSC
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define HAVE_RDTSC
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2
+#endif
+
+// structural index test
+static
+void structural_index_test()
+{
+	static const char symbols[] = { SOH, '=', '1', 'a' };
+
+	structural_index index = { 0, nullptr, nullptr };
+
+	srand(42);
+
+	for(size_t n = 0; n < 300; ++n)
+	{
+		std::string s(n, ' ');
+
+		for(size_t i = 0; i < n; ++i)
+			s[i] = symbols[rand() % sizeof(symbols)];
+
+		build_structural_index(&index, s.c_str(), n);
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			ensure(((index.soh[i / 64] >> (i % 64)) & 1) == (s[i] == SOH ? 1u : 0u));
+			ensure(((index.eq[i / 64] >> (i % 64)) & 1) == (s[i] == '=' ? 1u : 0u));
+		}
+	}
+
+	free_structural_index(&index);
+}
+
+// checksum benchmark: the parser computes checksums with the plain loops in fix.c, which the compiler
+// vectorizes by itself; the explicit SSE2 kernels below are the alternative they get measured against
+#if defined(HAVE_RDTSC) && defined(HAVE_SSE2)
+
+// the checksum is modulo 256, so bytes are accumulated in 8 bit lanes, and PSADBW against zero
+// sums the lanes up at the end
+static
+char copy_bytes_with_checksum_sse2(char* dst, const char* src, size_t n)
+{
+	size_t i = 0;
+	uint64_t lanes[2];
+	char sum;
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc0 = zero, acc1 = zero;
+
+	for(; i + 64 <= n; i += 64)
+	{
+		const __m128i
+			v0 = _mm_loadu_si128((const __m128i*)(src + i)),
+			v1 = _mm_loadu_si128((const __m128i*)(src + i + 16)),
+			v2 = _mm_loadu_si128((const __m128i*)(src + i + 32)),
+			v3 = _mm_loadu_si128((const __m128i*)(src + i + 48));
+
+		_mm_storeu_si128((__m128i*)(dst + i), v0);
+		_mm_storeu_si128((__m128i*)(dst + i + 16), v1);
+		_mm_storeu_si128((__m128i*)(dst + i + 32), v2);
+		_mm_storeu_si128((__m128i*)(dst + i + 48), v3);
+		acc0 = _mm_add_epi8(acc0, _mm_add_epi8(v0, v2));
+		acc1 = _mm_add_epi8(acc1, _mm_add_epi8(v1, v3));
+	}
+
+	for(; i + 16 <= n; i += 16)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+
+		_mm_storeu_si128((__m128i*)(dst + i), v);
+		acc0 = _mm_add_epi8(acc0, v);
+	}
+
+	_mm_storeu_si128((__m128i*)lanes, _mm_sad_epu8(_mm_add_epi8(acc0, acc1), zero));
+
+	for(sum = (char)(lanes[0] + lanes[1]); i < n; ++i)
+		sum += (dst[i] = src[i]);
+
+	return sum;
+}
+
+static
+char get_checksum_sse2(const char* s, size_t n)
+{
+	size_t i = 0;
+	uint64_t lanes[2];
+	char sum;
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc0 = zero, acc1 = zero;
+
+	for(; i + 64 <= n; i += 64)
+	{
+		acc0 = _mm_add_epi8(acc0, _mm_add_epi8(_mm_loadu_si128((const __m128i*)(s + i)), _mm_loadu_si128((const __m128i*)(s + i + 32))));
+		acc1 = _mm_add_epi8(acc1, _mm_add_epi8(_mm_loadu_si128((const __m128i*)(s + i + 16)), _mm_loadu_si128((const __m128i*)(s + i + 48))));
+	}
+
+	for(; i + 16 <= n; i += 16)
+		acc0 = _mm_add_epi8(acc0, _mm_loadu_si128((const __m128i*)(s + i)));
+
+	_mm_storeu_si128((__m128i*)lanes, _mm_sad_epu8(_mm_add_epi8(acc0, acc1), zero));
+
+	for(sum = (char)(lanes[0] + lanes[1]); i < n; ++i)
+		sum += s[i];
+
+	return sum;
+}
+
+// the parser's copy with checksum, as used for the message body
+static
+char copy_bytes_with_checksum(char* dst, const char* src, size_t n)
+{
+	string_buffer sb = { 0, n, dst };
+
+	return append_bytes_to_string_buffer_with_checksum(&sb, src, n);
+}
+
+// the kernels under comparison must agree with the parser
+static
+void checksum_test()
+{
+	std::vector<char> src(1000), dst1(src.size()), dst2(src.size());
+
+	srand(42);
+
+	for(size_t i = 0; i < src.size(); ++i)
+		src[i] = (char)rand();
+
+	for(size_t offset = 0; offset < 32; ++offset)
+	{
+		for(size_t n = 0; n < src.size() - offset; n += 7)
+		{
+			const char sum = copy_bytes_with_checksum(&dst1[offset], &src[offset], n);
+
+			ensure(copy_bytes_with_checksum_sse2(&dst2[offset], &src[offset], n) == sum);
+			ensure(memcmp(&dst1[offset], &dst2[offset], n) == 0);
+			ensure(get_checksum(&src[offset], n) == sum);
+			ensure(get_checksum_sse2(&src[offset], n) == sum);
+		}
+	}
+}
+
+static
+double checksum_speed(char (*kernel)(char*, const char*, size_t), const std::vector<char>& src, std::vector<char>& dst)
+{
+#ifdef _DEBUG
+	const size_t total = 1000000;
+#else
+	const size_t total = 100000000;
+#endif
+
+	const size_t N = total / src.size() + 1;
+	char sum = 0;
+	const uint64_t t_start = __rdtsc();
+
+	for(size_t i = 0; i < N; ++i)
+		sum += kernel(&dst[0], &src[0], src.size());
+
+	const uint64_t t_end = __rdtsc();
+
+	ensure(sum == (char)(N * (size_t)(unsigned char)get_checksum(&src[0], src.size())));
+
+	return (double)(N * src.size()) / (double)(t_end - t_start);
+}
+
+static
+void checksum_speed_test()
+{
+	static const size_t sizes[] = { 100, 1000, 10000, 100000 };
+
+	for(size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i)
+	{
+		std::vector<char> src(sizes[i]), dst(sizes[i]);
+
+		for(size_t j = 0; j < src.size(); ++j)
+			src[j] = (char)j;
+
+		const double scalar = checksum_speed(copy_bytes_with_checksum, src, dst),
+					 sse2 = checksum_speed(copy_bytes_with_checksum_sse2, src, dst);
+
+		printf("[Checksum] %u bytes: parser %.2f bytes/cycle, SSE2 %.2f bytes/cycle\n", (unsigned)sizes[i], scalar, sse2);
+	}
+}
+
+#endif	// HAVE_RDTSC && HAVE_SSE2
+
+// digits benchmark: the parser converts numbers with the plain loops in fix.c; the SWAR kernels below,
+// taking eight digits at a time in a 64 bit register, are the alternative they get measured against
+#ifdef HAVE_RDTSC
+
+// the first digit in the lowest byte (little-endian byte order, as on all the x86 targets)
+#define ONES(b)	((uint64_t)(b) * 0x0101010101010101ULL)
+
+// non-zero if any of the bytes is not a digit
+static
+uint64_t non_digit_mask(uint64_t x)
+{
+	return ((x & ONES(0xF0)) ^ ONES(0x30)) | (((x + ONES(0x06)) & ONES(0xF0)) ^ ONES(0x30));
+}
+
+static
+uint32_t parse_8_digits(uint64_t x)
+{
+	x -= ONES('0');
+	x = 10 * x + (x >> 8);	// pairs of digits in every other byte
+	x = (((x & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+		 + (((x >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+
+	return (uint32_t)x;
+}
+
+static
+uint32_t parse_4_digits(uint32_t x)
+{
+	x -= 0x30303030u;
+	x = 10 * x + (x >> 8);
+	return (((x & 0x00FF00FFu) * (1 + (100u << 16))) >> 16) & 0xFFFFu;
+}
+
+static
+size_t count_digits_swar(const char* s, size_t n)
+{
+	size_t i = 0;
+	uint64_t x;
+
+	for(; i + 8 <= n; i += 8)
+	{
+		memcpy(&x, s + i, 8);
+
+		if(non_digit_mask(x) != 0)
+			break;
+	}
+
+	for(; i < n && s[i] >= '0' && s[i] <= '9'; ++i);
+
+	return i;
+}
+
+static
+uint64_t parse_digits_swar(const char* s, size_t n)
+{
+	uint64_t r = 0, x;
+	uint32_t y;
+
+	for(; n >= 8; s += 8, n -= 8)
+	{
+		memcpy(&x, s, 8);
+		r = r * 100000000 + parse_8_digits(x);
+	}
+
+	if(n >= 4)
+	{
+		memcpy(&y, s, 4);
+		r = r * 10000 + parse_4_digits(y);
+		s += 4;
+		n -= 4;
+	}
+
+	for(; n > 0; --n)
+		r = 10 * r + (unsigned char)(*s++ - '0');
+
+	return r;
+}
+
+#undef ONES
+
+// the kernels under comparison must agree with the parser
+static
+void digits_test()
+{
+	static const char symbols[] = { '0', '1', '5', '9', '.', '/', ':', '\x01', '\xff' };
+
+	srand(42);
+
+	for(size_t n = 0; n < 40; ++n)
+	{
+		for(int k = 0; k < 200; ++k)
+		{
+			std::string s(n, ' ');
+
+			for(size_t i = 0; i < n; ++i)
+				s[i] = (rand() % 4 != 0) ? (char)('0' + rand() % 10) : symbols[rand() % sizeof(symbols)];
+
+			const size_t num_digits = count_digits(s.c_str(), n);
+
+			ensure(count_digits_swar(s.c_str(), n) == num_digits);
+
+			for(size_t m = 0; m <= num_digits && m <= 19; ++m)
+				ensure(parse_digits_swar(s.c_str(), m) == parse_digits(s.c_str(), m));
+		}
+	}
+
+	ensure(parse_digits("9999999999999999999", 19) == 9999999999999999999ULL);
+	ensure(parse_digits_swar("9999999999999999999", 19) == 9999999999999999999ULL);
+}
+
+// typical prices and quantities
+static
+double digits_speed(size_t (*count)(const char*, size_t), uint64_t (*parse)(const char*, size_t))
+{
+	static const char* const values[] = {
+		"100", "2500", "1000000", "35", "75000", "1.2345", "0.8765", "113.0625", "99.5", "1450.25",
+		"27.185", "0.00012345", "4312.75", "10", "98.765432", "123456.78", "3", "200000", "12.5", "1.09876"
+	};
+
+#ifdef _DEBUG
+	const size_t N = 10000;
+#else
+	const size_t N = 1000000;
+#endif
+
+	const size_t num_values = sizeof(values)/sizeof(values[0]);
+	size_t lengths[num_values];
+	uint64_t sum = 0;
+
+	for(size_t i = 0; i < num_values; ++i)
+		lengths[i] = strlen(values[i]);
+
+	const uint64_t t_start = __rdtsc();
+
+	for(size_t i = 0; i < N; ++i)
+	{
+		for(size_t j = 0; j < num_values; ++j)
+		{
+			const char* const s = values[j];
+			const size_t n = lengths[j], num_int = count(s, n);
+
+			sum += parse(s, num_int);
+
+			if(num_int < n)
+				sum += parse(s + num_int + 1, count(s + num_int + 1, n - num_int - 1));
+		}
+	}
+
+	const uint64_t t_end = __rdtsc();
+
+	ensure(sum > 0);
+
+	return (double)(t_end - t_start) / (double)(N * num_values);
+}
+
+static
+void digits_speed_test()
+{
+	const double scalar = digits_speed(count_digits, parse_digits),
+				 swar = digits_speed(count_digits_swar, parse_digits_swar);
+
+	printf("[Digits] prices and quantities: parser %.2f cycles/value, SWAR %.2f cycles/value\n", scalar, swar);
+}
+
+#endif	// HAVE_RDTSC
+
+// batch
+void all_simd_tests()
+{
+	structural_index_test();
+
+#if defined(HAVE_RDTSC) && defined(HAVE_SSE2)
+	checksum_test();
+	checksum_speed_test();
+#endif
+
+#ifdef HAVE_RDTSC
+	digits_test();
+	digits_speed_test();
+#endif
+}
@@ -23,6 +23,9 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 
 #include "test_messages.h"
 #include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <locale.h>
 #include <stdexcept>
 
 // FIX message for tests
@@ -79,6 +82,149 @@ void splitter_test()
 	ensure(counter == 4);
 }
 
+static
+void in_place_test()
+{
+	std::string s(copy_simple_message(4));
+	fix_parser* parser = create_fix_parser(get_dummy_classifier);
+
+	const size_t n = 200;
+	size_t counter = 0, in_place_counter = 0;
+	char* p = &s[0];
+	const char* const end = p + s.size();
+
+	for(; p < end; p += n)
+	{
+		const size_t len = std::min(n, (size_t)(end - p));
+
+		for(const fix_message* pm = get_first_fix_message_in_place(parser, p, len); pm; pm = get_next_fix_message(parser))
+		{
+			ensure(!pm->error);
+			validate_simple_message(pm);
+
+			const char* const value = get_fix_tag_as_string(get_fix_message_root_node(pm), 34);
+
+			if(value >= p && value < p + len)
+				++in_place_counter;
+
+			++counter;
+		}
+
+		ensure(!get_fix_parser_error(parser));
+	}
+
+	free_fix_parser(parser);
+	ensure(counter == 4);
+	ensure(in_place_counter > 0 && in_place_counter < 4);
+}
+
+// the message body must not stay in the input chunk when the trailer is in the next one
+static
+void in_place_split_trailer_test()
+{
+	std::string s(copy_simple_message());
+	const size_t split = s.rfind("10=") + 2;	// inside "10="
+
+	for(size_t i = split - 1; i <= split + 1; ++i)
+	{
+		std::string chunk1(s, 0, i), chunk2(s, i);
+		fix_parser* const parser = create_fix_parser(get_dummy_classifier);
+
+		ensure(!get_first_fix_message_in_place(parser, &chunk1[0], chunk1.size()));
+		ensure(!get_fix_parser_error(parser));
+
+		chunk1.assign(chunk1.size(), 'x');	// the caller reuses the chunk
+
+		const fix_message* const pm = get_first_fix_message_in_place(parser, &chunk2[0], chunk2.size());
+
+		ensure(pm && !pm->error);
+		validate_simple_message(pm);
+		ensure(!get_next_fix_message(parser));
+		free_fix_parser(parser);
+	}
+}
+
+// tags of a previous message must not be visible in the next one
+static
+void stale_tags_test()
+{
+	std::string big("8=FIX.4.4\x01" "9=0\x01" "35=D\x01");
+
+	for(int i = 0; i < 200; ++i)	// tags 1000 to 1199
+	{
+		big += '1';
+		big += (char)('0' + i / 100);
+		big += (char)('0' + (i / 10) % 10);
+		big += (char)('0' + i % 10);
+		big += "=X\x01";
+	}
+
+	const std::string s(make_fix_message(big.c_str()) + simple_message);
+	fix_parser* parser = create_fix_parser(get_dummy_classifier);
+	const fix_message* pm = get_first_fix_message(parser, s.c_str(), s.size());
+
+	ensure(pm && !pm->error);
+	ensure(get_fix_node_size(get_fix_message_root_node(pm)) == 200);
+	ensure_tag(get_fix_message_root_node(pm), 1100, "X");
+
+	pm = get_next_fix_message(parser);
+
+	ensure(pm && !pm->error);
+	validate_simple_message(pm);
+
+	for(size_t tag = 1000; tag < 1200; ++tag)
+		ensure(!get_fix_tag(get_fix_message_root_node(pm), tag));
+
+	ensure(!get_next_fix_message(parser));
+	free_fix_parser(parser);
+}
+
+// splitter recovery
+static
+void on_skip(void* context, size_t n)
+{
+	*(size_t*)context += n;
+}
+
+static
+void recovery_test(size_t step)
+{
+	std::string broken(simple_message, simple_message_size);
+
+	broken[broken.find("Marcel")] = 'm';	// invalid checksum
+
+	const std::string s("garbage123" + std::string(simple_message) + broken + std::string(simple_message) + "xx");
+	fix_parser* parser = create_fix_parser(get_dummy_classifier);
+	size_t counter = 0, skipped = 0;
+
+	enable_fix_parser_recovery(parser, on_skip, &skipped);
+
+	for(size_t i = 0; i < s.size(); i += step)
+	{
+		for(const fix_message* pm = get_first_fix_message(parser, s.c_str() + i, std::min(step, s.size() - i)); pm; pm = get_next_fix_message(parser))
+		{
+			ensure(!pm->error);
+			validate_simple_message(pm);
+			++counter;
+		}
+
+		ensure(!get_fix_parser_error(parser));
+	}
+
+	ensure(counter == 2);
+	ensure(skipped == 10 + simple_message_size);
+	ensure(get_fix_parser_skipped_bytes(parser) == 10 + simple_message_size + 2);
+	free_fix_parser(parser);
+}
+
+static
+void recovery_test()
+{
+	recovery_test(1000);
+	recovery_test(7);
+	recovery_test(1);
+}
+
 static
 void invalid_message_test()
 {
@@ -243,6 +389,476 @@ void test_binary_tag()
 	free_fix_parser(parser);
 }
 
+// conversion functions, tested on tag 52 of the message above
+static
+const fix_group_node* parse_message_with_tag_52(fix_parser* parser, std::string& msg, const char* value)
+{
+	msg.assign(m, sizeof(m) - 1);
+
+	const size_t pos = msg.find("52=") + 3;
+
+	msg.replace(pos, msg.find('\x01', pos) - pos, value);
+	msg = make_fix_message(msg.c_str());
+
+	const fix_message* const pm = get_first_fix_message(parser, msg.c_str(), msg.size());
+
+	ensure(pm && !pm->error);
+	return get_fix_message_root_node(pm);
+}
+
+// UTCTimestamp
+static
+int utc_timestamp_ns(fix_parser* parser, const char* value, int64_t* p_ns)
+{
+	std::string msg;
+
+	return get_fix_tag_as_utc_timestamp_ns(parse_message_with_tag_52(parser, msg, value), 52, p_ns);
+}
+
+static
+void ensure_utc_timestamp_ns(fix_parser* parser, const char* value, int num_frac, int64_t expected)
+{
+	int64_t ns = 0;
+
+	ensure(utc_timestamp_ns(parser, value, &ns) == num_frac);
+	ensure(ns == expected);
+}
+
+static
+void ensure_invalid_utc_timestamp(fix_parser* parser, const char* value)
+{
+	int64_t ns = 42;
+
+	ensure(utc_timestamp_ns(parser, value, &ns) == -1);
+	ensure(ns == 42);
+}
+
+static
+void ensure_utc_timestamp(fix_parser* parser, const char* value, int64_t expected)
+{
+	std::string msg;
+
+	ensure(get_fix_tag_as_utc_timestamp(parse_message_with_tag_52(parser, msg, value), 52) == expected);
+}
+
+static
+void utc_timestamp_test()
+{
+	fix_parser* const parser = create_fix_parser(m_message_classifier);
+	const int64_t s = 1267689570;	// 20100304-07:59:30
+
+	ensure_utc_timestamp_ns(parser, "20100304-07:59:30", 0, s * 1000000000);
+	ensure_utc_timestamp_ns(parser, "20100304-07:59:30.123", 3, s * 1000000000 + 123000000);
+	ensure_utc_timestamp_ns(parser, "20100304-07:59:30.123456", 6, s * 1000000000 + 123456000);
+	ensure_utc_timestamp_ns(parser, "20100304-07:59:30.123456789", 9, s * 1000000000 + 123456789);
+	ensure_utc_timestamp_ns(parser, "19700101-00:00:00.000000001", 9, 1);
+	ensure_utc_timestamp_ns(parser, "19691231-23:59:59.999", 3, -1000000);
+	ensure_utc_timestamp_ns(parser, "20000229-12:00:00", 0, 951825600LL * 1000000000);
+	ensure_utc_timestamp_ns(parser, "20161231-23:59:60", 0, 1483228800LL * 1000000000);	// leap second
+	ensure_utc_timestamp_ns(parser, "22620411-23:47:16.854775807", 9, 9223372036854775807LL);
+	ensure_utc_timestamp_ns(parser, "16770921-00:12:44", 0, -9223372036LL * 1000000000);
+
+	// 100 ns intervals, negative before the epoch
+#ifdef _WIN32
+	const int64_t epoch = 11644473600LL;
+#else
+	const int64_t epoch = 0;
+#endif
+
+	ensure_utc_timestamp(parser, "20100304-07:59:30.123", (epoch + s) * 10000000 + 1230000);
+	ensure_utc_timestamp(parser, "19691231-23:59:59.500", (epoch - 1) * 10000000 + 5000000);
+	ensure_utc_timestamp(parser, "19000101-00:00:00", (epoch - 2208988800LL) * 10000000);
+	ensure_utc_timestamp(parser, "15000101-00:00:00", (epoch - 14831769600LL) * 10000000);
+	ensure_utc_timestamp(parser, "20100230-07:59:30", -1);
+
+	ensure_invalid_utc_timestamp(parser, "20100304-07:59:3");
+	ensure_invalid_utc_timestamp(parser, "20100304-07:59:30.");
+	ensure_invalid_utc_timestamp(parser, "20100304-07:59:30.1234");
+	ensure_invalid_utc_timestamp(parser, "20100304-07:59:30.1234567890");
+	ensure_invalid_utc_timestamp(parser, "20100304 07:59:30");
+	ensure_invalid_utc_timestamp(parser, "20100304-07-59:30");
+	ensure_invalid_utc_timestamp(parser, "20100304-07:59:30,123");
+	ensure_invalid_utc_timestamp(parser, "2010O304-07:59:30");
+	ensure_invalid_utc_timestamp(parser, "20100304-07:59:30.12x");
+	ensure_invalid_utc_timestamp(parser, "20101304-07:59:30");
+	ensure_invalid_utc_timestamp(parser, "20100004-07:59:30");
+	ensure_invalid_utc_timestamp(parser, "20100300-07:59:30");
+	ensure_invalid_utc_timestamp(parser, "20100229-07:59:30");
+	ensure_invalid_utc_timestamp(parser, "21000229-07:59:30");
+	ensure_invalid_utc_timestamp(parser, "20100431-07:59:30");
+	ensure_invalid_utc_timestamp(parser, "20100304-24:00:00");
+	ensure_invalid_utc_timestamp(parser, "20100304-07:60:30");
+	ensure_invalid_utc_timestamp(parser, "20100304-07:59:61");
+	ensure_invalid_utc_timestamp(parser, "22620411-23:47:16.854775808");
+	ensure_invalid_utc_timestamp(parser, "99991231-23:59:59");
+	free_fix_parser(parser);
+}
+
+// date cache
+static
+time_t utc_date_only(fix_parser* parser, const char* value)
+{
+	std::string msg;
+
+	return get_fix_tag_as_utc_date_only(parse_message_with_tag_52(parser, msg, value), 52);
+}
+
+static
+void date_cache_test()
+{
+	fix_parser* const parser = create_fix_parser(m_message_classifier);
+	const int64_t s = 1267689570;	// 20100304-07:59:30
+
+	// same date with a different time
+	ensure_utc_timestamp_ns(parser, "20100304-07:59:30", 0, s * 1000000000);
+	ensure_utc_timestamp_ns(parser, "20100304-07:59:31.500", 3, (s + 1) * 1000000000 + 500000000);
+	ensure_utc_timestamp_ns(parser, "20100304-08:00:30.000001", 6, (s + 60) * 1000000000 + 1000);
+
+	// the time is still validated on a hit
+	ensure_invalid_utc_timestamp(parser, "20100304-25:00:00");
+	ensure_invalid_utc_timestamp(parser, "20100304-07:5x:30");
+
+	// the next day, and back
+	ensure_utc_timestamp_ns(parser, "20100305-07:59:30", 0, (s + 86400) * 1000000000);
+	ensure_utc_timestamp_ns(parser, "20100304-07:59:30", 0, s * 1000000000);
+
+	// an invalid date does not get cached
+	ensure_invalid_utc_timestamp(parser, "20100230-07:59:30");
+	ensure_invalid_utc_timestamp(parser, "20100230-07:59:30");
+	ensure_utc_timestamp_ns(parser, "20100304-07:59:30", 0, s * 1000000000);
+
+	// date-only fields have a cache entry of their own
+	ensure(utc_date_only(parser, "20100304") == (time_t)1267660800);
+	ensure(utc_date_only(parser, "20100304") == (time_t)1267660800);
+	ensure(utc_date_only(parser, "20100305") == (time_t)1267747200);
+	ensure(utc_date_only(parser, "2010030x") == (time_t)-1);
+	ensure(utc_date_only(parser, "201003041") == (time_t)-1);
+	ensure_utc_timestamp_ns(parser, "20100305-07:59:30", 0, (s + 86400) * 1000000000);
+	ensure(utc_date_only(parser, "20100305") == (time_t)1267747200);
+
+	free_fix_parser(parser);
+}
+
+// other date and time types
+static
+time_t local_midnight(int year, int month, int day)
+{
+	struct tm t = {};
+
+	t.tm_year = year - 1900;
+	t.tm_mon = month - 1;
+	t.tm_mday = day;
+	t.tm_isdst = -1;
+
+	return mktime(&t);
+}
+
+static
+void date_time_types_test()
+{
+	fix_parser* const parser = create_fix_parser(m_message_classifier);
+	std::string msg;
+	const fix_group_node* node;
+	int64_t ns = 42;
+	fix_month_year my;
+
+	// LocalMktDate and UTCDateOnly
+	node = parse_message_with_tag_52(parser, msg, "20100304");
+	ensure(get_fix_tag_as_local_mkt_date(node, 52) == local_midnight(2010, 3, 4));
+	ensure(get_fix_tag_as_local_mkt_date_tz(node, 52, 0) == (time_t)1267660800);
+	ensure(get_fix_tag_as_local_mkt_date_tz(node, 52, -300) == (time_t)(1267660800 + 5 * 3600));
+	ensure(get_fix_tag_as_local_mkt_date_tz(node, 52, 330) == (time_t)(1267660800 - 330 * 60));
+	ensure(get_fix_tag_as_utc_date_only(node, 52) == (time_t)1267660800);
+	ensure(get_fix_tag_as_utc_date_only(node, 34) == (time_t)-1);
+	ensure(get_fix_tag_as_utc_date_only(node, 99) == (time_t)-1);
+
+	node = parse_message_with_tag_52(parser, msg, "19000101");
+	ensure(get_fix_tag_as_utc_date_only(node, 52) == (time_t)(-2208988800LL));
+	node = parse_message_with_tag_52(parser, msg, "20100229");
+	ensure(get_fix_tag_as_local_mkt_date(node, 52) == (time_t)-1);
+
+	// beyond 2038 only with 64 bit time_t
+	node = parse_message_with_tag_52(parser, msg, "21000101");
+	ensure(get_fix_tag_as_utc_date_only(node, 52) == (sizeof(time_t) > 4 ? (time_t)4102444800LL : (time_t)-1));
+	ensure(get_fix_tag_as_local_mkt_date_tz(node, 52, -300) == (sizeof(time_t) > 4 ? (time_t)(4102444800LL + 5 * 3600) : (time_t)-1));
+	ensure(get_fix_tag_as_local_mkt_date(node, 52) == local_midnight(2100, 1, 1));
+
+	// UTCTimeOnly
+	node = parse_message_with_tag_52(parser, msg, "07:59:30");
+	ensure(get_fix_tag_as_utc_time_only(node, 52, &ns) == 0 && ns == 28770 * 1000000000LL);
+	node = parse_message_with_tag_52(parser, msg, "07:59:30.001");
+	ensure(get_fix_tag_as_utc_time_only(node, 52, &ns) == 3 && ns == 28770 * 1000000000LL + 1000000);
+	node = parse_message_with_tag_52(parser, msg, "23:59:60.999999999");
+	ensure(get_fix_tag_as_utc_time_only(node, 52, &ns) == 9 && ns == 86400 * 1000000000LL + 999999999);
+	ns = 42;
+	node = parse_message_with_tag_52(parser, msg, "07:59");
+	ensure(get_fix_tag_as_utc_time_only(node, 52, &ns) == -1 && ns == 42);
+	node = parse_message_with_tag_52(parser, msg, "24:00:00");
+	ensure(get_fix_tag_as_utc_time_only(node, 52, &ns) == -1 && ns == 42);
+
+	// TZTimestamp, examples from the spec
+	const int64_t t = 1157096340LL * 1000000000;	// 20060901-07:39 UTC
+
+	node = parse_message_with_tag_52(parser, msg, "20060901-07:39Z");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == 0 && ns == t);
+	node = parse_message_with_tag_52(parser, msg, "20060901-02:39-05");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == 0 && ns == t);
+	node = parse_message_with_tag_52(parser, msg, "20060901-15:39+08");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == 0 && ns == t);
+	node = parse_message_with_tag_52(parser, msg, "20060901-13:09+05:30");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == 0 && ns == t);
+	node = parse_message_with_tag_52(parser, msg, "20060901-07:39:01.5Z");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == -1);
+	node = parse_message_with_tag_52(parser, msg, "20060901-07:39:01.500Z");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == 3 && ns == t + 1500000000);
+	node = parse_message_with_tag_52(parser, msg, "20060901-01:39:00.000001-06:00");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == 6 && ns == t + 1000);
+	node = parse_message_with_tag_52(parser, msg, "20060901-07:39:00");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == 0 && ns == t);
+	node = parse_message_with_tag_52(parser, msg, "20060901-00:39-07");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == 0 && ns == t);
+	node = parse_message_with_tag_52(parser, msg, "20060902-00:39+17");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == 0 && ns == t);
+
+	ns = 42;
+	node = parse_message_with_tag_52(parser, msg, "20060901-07:39Z+01");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == -1);
+	node = parse_message_with_tag_52(parser, msg, "20060901-07:39+1");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == -1);
+	node = parse_message_with_tag_52(parser, msg, "20060901-07:39+01:3");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == -1);
+	node = parse_message_with_tag_52(parser, msg, "20060901-07:39+01-30");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == -1);
+	node = parse_message_with_tag_52(parser, msg, "20060901-07:3Z");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == -1);
+	node = parse_message_with_tag_52(parser, msg, "20060931-07:39Z");
+	ensure(get_fix_tag_as_tz_timestamp(node, 52, &ns) == -1);
+	ensure(ns == 42);
+
+	// MonthYear
+	node = parse_message_with_tag_52(parser, msg, "201003");
+	ensure(get_fix_tag_as_month_year(node, 52, &my) && my.year == 2010 && my.month == 3 && my.day == 0 && my.week == 0);
+	node = parse_message_with_tag_52(parser, msg, "20100331");
+	ensure(get_fix_tag_as_month_year(node, 52, &my) && my.year == 2010 && my.month == 3 && my.day == 31 && my.week == 0);
+	node = parse_message_with_tag_52(parser, msg, "201003w2");
+	ensure(get_fix_tag_as_month_year(node, 52, &my) && my.year == 2010 && my.month == 3 && my.day == 0 && my.week == 2);
+	node = parse_message_with_tag_52(parser, msg, "201013");
+	ensure(!get_fix_tag_as_month_year(node, 52, &my));
+	node = parse_message_with_tag_52(parser, msg, "20100431");
+	ensure(!get_fix_tag_as_month_year(node, 52, &my));
+	node = parse_message_with_tag_52(parser, msg, "201003w6");
+	ensure(!get_fix_tag_as_month_year(node, 52, &my));
+	node = parse_message_with_tag_52(parser, msg, "2010031");
+	ensure(!get_fix_tag_as_month_year(node, 52, &my));
+
+	free_fix_parser(parser);
+}
+
+// numbers
+static
+void ensure_integer(fix_parser* parser, const char* value, bool ok, int64_t expected = 0)
+{
+	std::string msg;
+	const fix_group_node* const node = parse_message_with_tag_52(parser, msg, value);
+	int64_t r = 42;
+
+	ensure(get_fix_tag_as_integer(node, 52, &r) == (ok ? 1 : 0));
+	ensure(r == (ok ? expected : 42));
+}
+
+static
+void ensure_decimal(fix_parser* parser, const char* value, bool ok, int64_t mantissa = 0, int exponent = 0)
+{
+	std::string msg;
+	const fix_group_node* const node = parse_message_with_tag_52(parser, msg, value);
+	fix_decimal r = { 42, 42 };
+
+	ensure(get_fix_tag_as_decimal(node, 52, &r) == (ok ? 1 : 0));
+	ensure(ok ? (r.mantissa == mantissa && r.exponent == exponent) : (r.mantissa == 42 && r.exponent == 42));
+}
+
+static
+void ensure_real(fix_parser* parser, const char* value, int num_frac, int64_t expected = 0)
+{
+	std::string msg;
+	const fix_group_node* const node = parse_message_with_tag_52(parser, msg, value);
+	int64_t r = 42;
+
+	ensure(get_fix_tag_as_real(node, 52, &r) == num_frac);
+	ensure(r == (num_frac >= 0 ? expected : 42));
+}
+
+static
+void ensure_double(fix_parser* parser, const char* value, bool ok = true)
+{
+	std::string msg;
+	const fix_group_node* const node = parse_message_with_tag_52(parser, msg, value);
+	double r = 42.;
+
+	if(ok)
+	{
+		const char* const point = strchr(value, '.');
+
+		const double expected = strtod(value, nullptr);
+
+		// bitwise, so the sign of zero counts too
+		ensure(get_fix_tag_as_double(node, 52, &r) == (point ? (int)strlen(point + 1) : 0));
+		ensure(memcmp(&r, &expected, sizeof(r)) == 0);
+	}
+	else
+	{
+		ensure(get_fix_tag_as_double(node, 52, &r) == -1);
+		ensure(r == 42.);
+	}
+}
+
+static
+void number_test()
+{
+	fix_parser* const parser = create_fix_parser(m_message_classifier);
+
+	ensure_integer(parser, "0", true, 0);
+	ensure_integer(parser, "-0", true, 0);
+	ensure_integer(parser, "99999", true, 99999);
+	ensure_integer(parser, "-99999", true, -99999);
+	ensure_integer(parser, "00023", true, 23);
+	ensure_integer(parser, "123456789012345678", true, 123456789012345678LL);
+	ensure_integer(parser, "9223372036854775807", true, 9223372036854775807LL);
+	ensure_integer(parser, "-9223372036854775808", true, -9223372036854775807LL - 1);
+	ensure_integer(parser, "0000000000000000000009223372036854775807", true, 9223372036854775807LL);
+	ensure_integer(parser, "9223372036854775808", false);
+	ensure_integer(parser, "-9223372036854775809", false);
+	ensure_integer(parser, "18446744073709551616", false);
+	ensure_integer(parser, "99999999999999999999", false);
+	ensure_integer(parser, "-", false);
+	ensure_integer(parser, "+1", false);
+	ensure_integer(parser, "12a", false);
+	ensure_integer(parser, "1234567890123456x", false);
+	ensure_integer(parser, "1.0", false);
+
+	ensure_decimal(parser, "23", true, 23, 0);
+	ensure_decimal(parser, "23.", true, 23, 0);
+	ensure_decimal(parser, "23.50", true, 2350, -2);
+	ensure_decimal(parser, "-00023.23", true, -2323, -2);
+	ensure_decimal(parser, "0.00012345", true, 12345, -8);
+	ensure_decimal(parser, "1234.56789012", true, 123456789012LL, -8);
+	ensure_decimal(parser, "92233720368547758.07", true, 9223372036854775807LL, -2);
+	ensure_decimal(parser, "-92233720368547758.08", true, -9223372036854775807LL - 1, -2);
+	ensure_decimal(parser, "92233720368547758.0700000", true, 9223372036854775807LL, -2);
+	ensure_decimal(parser, "0.0000000000000000000000001", true, 1, -25);
+	ensure_decimal(parser, "92233720368547758.08", false);
+	ensure_decimal(parser, "922337203685477580.8", false);
+	ensure_decimal(parser, ".5", false);
+	ensure_decimal(parser, "1.2.3", false);
+	ensure_decimal(parser, "1,5", false);
+	ensure_decimal(parser, "1.5e3", false);
+
+	ensure_real(parser, "23.0000", 4, 230000);
+	ensure_real(parser, "-1.5", 1, -15);
+	ensure_real(parser, "123456789012345", 0, 123456789012345LL);
+	ensure_real(parser, "12345678.9012345", 7, 123456789012345LL);
+	ensure_real(parser, "1234567890123456", -1);
+	ensure_real(parser, "1.5x", -1);
+
+	// doubles must match strtod() exactly
+	static const char* const doubles[] = {
+		"0", "-0", "-0.0", "-0.000000000000000000000000", "0.1", "0.3", "-1.5", "113.0625", "0.30000000000000004", "1234.5678", "99.99",
+		"9007199254740993", "9007199254740993.0", "9007199254740995", "18014398509481985",
+		"1234567890123456789", "0.1234567890123456789", "9.999999999999999999", "12345678901234.56789",
+		"0.000000000000000000000000000000000000000000000000000000000000012345",
+		"0.00000000000000000000000000000000000000000000000000000000000000000001",
+		"3.14159265358979323846264338327950288", "00000000000000000000000000000000000000001.5"
+	};
+
+	for(size_t i = 0; i < sizeof(doubles)/sizeof(doubles[0]); ++i)
+		ensure_double(parser, doubles[i]);
+
+	srand(42);
+
+	for(int i = 0; i < 40000; ++i)
+	{
+		// prices, then long values for the slow paths
+		const int num_int = 1 + rand() % ((i % 2) ? 20 : 8), num_frac = rand() % ((i % 2) ? 40 : 8);
+		std::string value((rand() % 2) ? "-" : "");
+
+		for(int j = 0; j < num_int; ++j)
+			value += (char)('0' + rand() % 10);
+
+		if(i % 4 == 1)
+			value = "0";
+
+		if(num_frac > 0)
+			value += '.';
+
+		for(int j = 0; j < num_frac; ++j)
+			value += (char)('0' + rand() % 10);
+
+		ensure_double(parser, value.c_str());
+	}
+
+	ensure_double(parser, "1.5e3", false);
+	ensure_double(parser, " 1.5", false);
+	ensure_double(parser, "inf", false);
+	ensure_double(parser, "0x10", false);
+
+	free_fix_parser(parser);
+}
+
+// the decimal point of the current locale must not change the conversion
+static
+void locale_test()
+{
+	static const char* const locales[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "ru_RU.UTF-8", "German" };
+	static const char value[] = "3.14159265358979323846264338327950288";	// too long for the fast paths
+
+	const double expected = strtod(value, nullptr);
+	size_t i;
+
+	for(i = 0; i < sizeof(locales)/sizeof(locales[0]) && !setlocale(LC_NUMERIC, locales[i]); ++i);
+
+	if(i == sizeof(locales)/sizeof(locales[0]))
+		return;	// no such locale installed
+
+	fix_parser* const parser = create_fix_parser(m_message_classifier);
+	std::string msg;
+	double r = 0.;
+
+	ensure(get_fix_tag_as_double(parse_message_with_tag_52(parser, msg, value), 52, &r) == (int)strlen(strchr(value, '.') + 1));
+	ensure(r == expected);
+
+	free_fix_parser(parser);
+	setlocale(LC_NUMERIC, "C");
+}
+
+// LocalMktDate follows the time zone of the process, daylight saving time included
+static
+void local_mkt_date_test()
+{
+#ifndef _WIN32
+	const char* const tz = getenv("TZ");
+	const std::string saved(tz ? tz : "");
+
+	ensure(setenv("TZ", "EST5EDT,M3.2.0,M11.1.0", 1) == 0);
+	tzset();
+
+	fix_parser* const parser = create_fix_parser(m_message_classifier);
+	std::string msg;
+
+	ensure(get_fix_tag_as_local_mkt_date(parse_message_with_tag_52(parser, msg, "20100304"), 52) == (time_t)(1267660800 + 5 * 3600));
+	ensure(get_fix_tag_as_local_mkt_date(parse_message_with_tag_52(parser, msg, "20100704"), 52) == (time_t)(1278201600 + 4 * 3600));
+	ensure(get_fix_tag_as_local_mkt_date_tz(parse_message_with_tag_52(parser, msg, "20100704"), 52, 0) == (time_t)1278201600);
+
+	free_fix_parser(parser);
+
+	if(tz)
+		setenv("TZ", saved.c_str(), 1);
+	else
+		unsetenv("TZ");
+
+	tzset();
+#endif
+}
+
 // speed test
 static
 void speed_test()
@@ -255,8 +871,18 @@ void all_simple_tests()
 {
 	basic_test();
 	splitter_test();
+	in_place_test();
+	in_place_split_trailer_test();
+	stale_tags_test();
+	recovery_test();
 	invalid_message_test();
 	invalid_message_test2();
 	test_binary_tag();
+	utc_timestamp_test();
+	date_cache_test();
+	date_time_types_test();
+	local_mkt_date_test();
+	number_test();
+	locale_test();
 	speed_test();
 }